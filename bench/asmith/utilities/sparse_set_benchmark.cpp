@@ -0,0 +1,106 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "asmith/utilities/benchmark.hpp"
+#include "asmith/utilities/sparse_set.hpp"
+
+using namespace asmith;
+
+namespace {
+	typedef sparse_set<uint32_t, float> position_set;
+	typedef sparse_set<uint32_t, float> velocity_set;
+
+	/*!
+		\brief Fill two sets where neither is a subset of the other.
+		\detail The first set holds random IDs, the second holds every third ID, so each has IDs the other does not.
+	*/
+	void make_sets(const size_t aSize, position_set& aPositions, velocity_set& aVelocities) {
+		std::mt19937 rng(static_cast<uint32_t>(aSize));
+		const uint32_t range = static_cast<uint32_t>(aSize * 3);
+		while(aPositions.size() < aSize) {
+			const uint32_t id = rng() % range;
+			aPositions.emplace(id, static_cast<float>(id));
+		}
+		for(uint32_t id = 0; id < range; id += 3) aVelocities.emplace(id, static_cast<float>(id) * 0.5f);
+	}
+
+	/*!
+		\brief Check that group_with lines up the IDs and values of both sets.
+		\return False if any shared position holds different IDs or a value that does not belong to its ID.
+	*/
+	bool check_group_with(const size_t aSize) {
+		position_set positions;
+		velocity_set velocities;
+		make_sets(aSize, positions, velocities);
+
+		size_t shared = 0;
+		const uint32_t* const ids = positions.ids();
+		for(size_t i = 0; i < positions.size(); ++i) if(velocities.contains(ids[i])) ++shared;
+
+		const size_t count = positions.group_with(velocities);
+		if(count != shared) return false;
+		for(size_t i = 0; i < count; ++i) {
+			const uint32_t id = positions.ids()[i];
+			if(velocities.ids()[i] != id) return false;
+			if(positions.data()[i] != static_cast<float>(id) || velocities.data()[i] != static_cast<float>(id) * 0.5f) return false;
+			if(positions.index_of(id) != i || velocities.index_of(id) != i) return false;
+		}
+		return true;
+	}
+
+	void for_each_intersection_benchmark(benchmark_state& aState) {
+		aState.pause_timing();
+		position_set positions;
+		velocity_set velocities;
+		make_sets(static_cast<size_t>(aState.get_parameter()), positions, velocities);
+		aState.resume_timing();
+		for(uint64_t i = 0; i < aState.get_iterations(); ++i) {
+			for_each_intersection([](const uint32_t, float& aPosition, float& aVelocity) {
+				aPosition += aVelocity;
+			}, positions, velocities);
+			clobber_memory();
+		}
+		aState.set_items_per_iteration(positions.size());
+	}
+
+	void group_with_benchmark(benchmark_state& aState) {
+		aState.pause_timing();
+		position_set positions;
+		velocity_set velocities;
+		make_sets(static_cast<size_t>(aState.get_parameter()), positions, velocities);
+		const size_t count = positions.group_with(velocities);
+		aState.resume_timing();
+		for(uint64_t i = 0; i < aState.get_iterations(); ++i) {
+			float* const p = positions.data();
+			const float* const v = velocities.data();
+			for(size_t j = 0; j < count; ++j) p[j] += v[j];
+			clobber_memory();
+		}
+		aState.set_items_per_iteration(positions.size());
+	}
+}
+
+int main(int aArgc, char** aArgv) {
+	if(! check_group_with(4096)) {
+		std::fprintf(stderr, "sparse_set::group_with : shared prefixes do not line up\n");
+		return 1;
+	}
+
+	benchmark_suite suite;
+	suite.add("sparse_set::for_each_intersection", for_each_intersection_benchmark, { 1024, 65536, 1048576 });
+	suite.add("sparse_set::group_with", group_with_benchmark, { 1024, 65536, 1048576 });
+	return suite.main(aArgc, aArgv);
+}
@@ -0,0 +1,153 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "asmith/utilities/benchmark.hpp"
+#include "asmith/utilities/strings.hpp"
+
+using namespace asmith;
+
+namespace {
+	const std::vector<uint64_t> SIZES = { 64, 4096, 262144 };
+
+	/*!
+		\brief Generate random printable text.
+	*/
+	std::string make_text(const size_t aSize) {
+		static const char CHARACTERS[] = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ\t";
+		std::mt19937 rng(static_cast<uint32_t>(aSize));
+		std::string tmp(aSize, ' ');
+		for(char& c : tmp) c = CHARACTERS[rng() % (sizeof(CHARACTERS) - 1)];
+		return tmp;
+	}
+
+	/*!
+		\brief Generate a whitespace separated list of numbers, with the given number of values.
+	*/
+	std::string make_numbers(const size_t aCount, const bool aReal) {
+		std::mt19937 rng(static_cast<uint32_t>(aCount));
+		std::string tmp;
+		char buffer[32];
+		for(size_t i = 0; i < aCount; ++i) {
+			if(aReal) {
+				std::snprintf(buffer, sizeof(buffer), "%.6f ", static_cast<double>(static_cast<int32_t>(rng())) / 1000.0);
+			}else {
+				std::snprintf(buffer, sizeof(buffer), "%d ", static_cast<int32_t>(rng()));
+			}
+			tmp += buffer;
+		}
+		return tmp;
+	}
+
+	void find_substring_benchmark(benchmark_state& aState) {
+		aState.pause_timing();
+		std::string text = make_text(aState.get_parameter());
+		text.back() = '\0';
+		const char* const needle = "xyzzy";
+		aState.resume_timing();
+		for(uint64_t i = 0; i < aState.get_iterations(); ++i) {
+			do_not_optimise(strings::find_substring(text.c_str(), text.size(), needle, 5));
+		}
+		aState.set_bytes_per_iteration(text.size());
+	}
+
+	void find_any_benchmark(benchmark_state& aState) {
+		aState.pause_timing();
+		const std::string text = make_text(aState.get_parameter());
+		const char* const characters = "0123456789";
+		aState.resume_timing();
+		for(uint64_t i = 0; i < aState.get_iterations(); ++i) {
+			do_not_optimise(strings::find_any(text.c_str(), text.size(), characters, 10));
+		}
+		aState.set_bytes_per_iteration(text.size());
+	}
+
+	void find_number_benchmark(benchmark_state& aState) {
+		aState.pause_timing();
+		const std::string text = make_text(aState.get_parameter());
+		aState.resume_timing();
+		for(uint64_t i = 0; i < aState.get_iterations(); ++i) {
+			do_not_optimise(strings::find_number(text.c_str(), text.size()));
+		}
+		aState.set_bytes_per_iteration(text.size());
+	}
+
+	void strcmp_ignore_case_benchmark(benchmark_state& aState) {
+		aState.pause_timing();
+		const std::string a = make_text(aState.get_parameter());
+		std::string b = a;
+		strings::to_upper_case(&b[0], b.size());
+		aState.resume_timing();
+		for(uint64_t i = 0; i < aState.get_iterations(); ++i) {
+			do_not_optimise(strings::strcmp_ignore_case(a.c_str(), b.c_str(), a.size()));
+		}
+		aState.set_bytes_per_iteration(a.size());
+	}
+
+	void to_upper_case_benchmark(benchmark_state& aState) {
+		aState.pause_timing();
+		const std::string source = make_text(aState.get_parameter());
+		std::string text = source;
+		aState.resume_timing();
+		for(uint64_t i = 0; i < aState.get_iterations(); ++i) {
+			// Restore the lower case input so that every iteration converts the same text
+			aState.pause_timing();
+			text.assign(source);
+			clobber_memory();
+			aState.resume_timing();
+			strings::to_upper_case(&text[0], text.size());
+			clobber_memory();
+		}
+		aState.set_bytes_per_iteration(text.size());
+	}
+
+	template<class T, const char*(*READ)(const char*, T&)>
+	void read_benchmark(benchmark_state& aState, const bool aReal) {
+		aState.pause_timing();
+		const std::string text = make_numbers(static_cast<size_t>(aState.get_parameter()), aReal);
+		aState.resume_timing();
+		for(uint64_t i = 0; i < aState.get_iterations(); ++i) {
+			const char* pos = text.c_str();
+			T value;
+			for(uint64_t j = 0; j < aState.get_parameter(); ++j) {
+				pos = strings::skip_whitespace(READ(pos, value));
+				do_not_optimise(value);
+			}
+		}
+		aState.set_bytes_per_iteration(text.size());
+		aState.set_items_per_iteration(aState.get_parameter());
+	}
+
+	void read_32i_benchmark(benchmark_state& aState) {
+		read_benchmark<int32_t, strings::read_32i>(aState, false);
+	}
+
+	void read_d_benchmark(benchmark_state& aState) {
+		read_benchmark<double, strings::read_d>(aState, true);
+	}
+}
+
+int main(int aArgc, char** aArgv) {
+	benchmark_suite suite;
+	suite.add("strings::find_substring", find_substring_benchmark, SIZES);
+	suite.add("strings::find_any", find_any_benchmark, SIZES);
+	suite.add("strings::find_number", find_number_benchmark, SIZES);
+	suite.add("strings::strcmp_ignore_case", strcmp_ignore_case_benchmark, SIZES);
+	suite.add("strings::to_upper_case", to_upper_case_benchmark, SIZES);
+	suite.add("strings::read_32i", read_32i_benchmark, { 16, 1024, 65536 });
+	suite.add("strings::read_d", read_d_benchmark, { 16, 1024, 65536 });
+	return suite.main(aArgc, aArgv);
+}
\ No newline at end of file
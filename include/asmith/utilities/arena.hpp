@@ -0,0 +1,283 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_ARENA_HPP
+#define ASMITH_UTILITIES_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+	#if __has_include(<memory_resource>)
+		#include <memory_resource>
+		#define ASMITH_ARENA_PMR_AVAILABLE
+	#endif
+#endif
+
+namespace asmith {
+
+	namespace implementation {
+		enum : size_t {
+			ARENA_DEFAULT_BLOCK_SIZE = 4096,	//!< Size of the first heap block of an arena
+			SCRATCH_BLOCK_SIZE = 1 << 16,		//!< Size of the first heap block of a thread's scratch arena
+			SCRATCH_LIMIT = 1 << 20				//!< Allocations larger than this bypass the scratch arena in the default statistics overloads
+		};
+	}
+
+	/*!
+		\brief A monotonic (bump pointer) allocator.
+		\detail Memory is handed out from the current block by advancing a pointer, individual allocations are never
+		freed. When a block is full a new block at least twice as large is taken from the heap. An initial buffer can be
+		supplied by the caller (for example an array on the stack), in which case the heap is only used once it is full.
+		\n get_marker and rewind return all memory allocated after a point in LIFO order. Rewound blocks are kept and
+		reused, so a loop that rewinds after each iteration stops calling the heap once it has reached its peak size.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class monotonic_arena {
+	public:
+		/*!
+			\brief A position in the arena that can be rewound to.
+		*/
+		struct marker {
+			void* block;		//!< The block that was current
+			uint8_t* position;	//!< The next free byte in that block
+		};
+	private:
+		struct block {
+			block* next;		//!< The previous block in use, or the next spare block
+			size_t size;		//!< Usable bytes after the header
+		};
+
+		uint8_t* mPosition;		//!< Next free byte in the current block
+		uint8_t* mEnd;			//!< End of the current block
+		block* mBlocks;			//!< Heap blocks in use, newest first, nullptr while using the initial buffer
+		block* mSpare;			//!< Heap blocks that have been rewound, kept for reuse
+		uint8_t* const mInitial;
+		const size_t mInitialSize;
+		size_t mNextSize;		//!< Minimum size of the next heap block
+
+		monotonic_arena(const monotonic_arena&) = delete;
+		monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+		enum : size_t {
+			HEADER_SIZE = (sizeof(block) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1)	//!< Keeps block data aligned to max_align_t
+		};
+
+		static uint8_t* block_data(block* const aBlock) throw() {
+			return reinterpret_cast<uint8_t*>(aBlock) + HEADER_SIZE;
+		}
+
+		void* allocate_slow(const size_t aSize, const size_t aAlignment);
+	public:
+		/*!
+			\brief Create an arena that allocates blocks from the heap.
+			\param aBlockSize The size of the first block.
+		*/
+		monotonic_arena(const size_t aBlockSize = implementation::ARENA_DEFAULT_BLOCK_SIZE) throw();
+
+		/*!
+			\brief Create an arena that uses a caller supplied buffer before the heap.
+			\param aBuffer The buffer, it must outlive the arena.
+			\param aSize The size of the buffer in bytes.
+		*/
+		monotonic_arena(void* const aBuffer, const size_t aSize) throw();
+
+		/*!
+			\brief Free every heap block.
+		*/
+		~monotonic_arena() throw();
+
+		/*!
+			\brief Allocate memory.
+			\param aSize The number of bytes.
+			\param aAlignment The alignment, must be a power of 2.
+			\return The memory, which is valid until the arena is rewound, reset or destroyed.
+			\throw std::bad_alloc If a new block could not be allocated.
+		*/
+		inline void* allocate(const size_t aSize, const size_t aAlignment = alignof(std::max_align_t)) {
+			const uintptr_t aligned = (reinterpret_cast<uintptr_t>(mPosition) + aAlignment - 1) & ~static_cast<uintptr_t>(aAlignment - 1);
+			const uintptr_t end = reinterpret_cast<uintptr_t>(mEnd);
+			if(aligned <= end && end - aligned >= aSize) {
+				mPosition = reinterpret_cast<uint8_t*>(aligned + aSize);
+				return reinterpret_cast<void*>(aligned);
+			}
+			return allocate_slow(aSize, aAlignment);
+		}
+
+		/*!
+			\brief Allocate uninitialised memory for an array.
+			\param aCount The number of elements.
+		*/
+		template<class T>
+		inline T* allocate_array(const size_t aCount) {
+			if(aCount > static_cast<size_t>(-1) / sizeof(T)) throw std::bad_alloc();
+			return static_cast<T*>(allocate(aCount * sizeof(T), alignof(T)));
+		}
+
+		/*!
+			\brief Get the current position so that later allocations can be returned with rewind.
+		*/
+		inline marker get_marker() const throw() {
+			marker tmp;
+			tmp.block = mBlocks;
+			tmp.position = mPosition;
+			return tmp;
+		}
+
+		/*!
+			\brief Return all memory that was allocated after a marker was taken.
+			\detail Markers must be rewound in the reverse order that they were taken.
+		*/
+		void rewind(const marker aMarker) throw();
+
+		/*!
+			\brief Return all memory, heap blocks are kept for reuse.
+		*/
+		void reset() throw();
+
+		/*!
+			\brief Return all memory and free every heap block.
+		*/
+		void release() throw();
+
+		/*!
+			\brief Get the number of bytes in heap blocks owned by the arena, including spare blocks.
+		*/
+		size_t get_heap_size() const throw();
+	};
+
+	/*!
+		\brief Rewinds an arena to the position it was at when the scope was created.
+		\detail The default constructor uses the calling thread's scratch arena.
+	*/
+	class scratch_scope {
+	private:
+		monotonic_arena& mArena;
+		const monotonic_arena::marker mMarker;
+
+		scratch_scope(const scratch_scope&) = delete;
+		scratch_scope& operator=(const scratch_scope&) = delete;
+	public:
+		scratch_scope();
+
+		explicit scratch_scope(monotonic_arena& aArena) throw() :
+			mArena(aArena),
+			mMarker(aArena.get_marker())
+		{}
+
+		~scratch_scope() throw() {
+			mArena.rewind(mMarker);
+		}
+
+		/*!
+			\brief Get the arena that the scope rewinds.
+		*/
+		monotonic_arena& get_arena() const throw() {
+			return mArena;
+		}
+	};
+
+	/*!
+		\brief Get the calling thread's scratch arena.
+		\detail Intended for temporary buffers inside a function, allocations should be made inside a scratch_scope
+		so that they are returned when the function exits. The arena keeps its peak size until the thread exits.
+	*/
+	monotonic_arena& scratch_arena();
+
+	/*!
+		\brief A standard library allocator that allocates from a monotonic_arena.
+		\detail deallocate does nothing, memory is returned when the arena is rewound, reset or destroyed.
+		\tparam T The type of object to allocate.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T>
+	class arena_allocator {
+	private:
+		monotonic_arena* mArena;
+
+		template<class T2>
+		friend class arena_allocator;
+	public:
+		typedef T value_type;
+
+		arena_allocator(monotonic_arena& aArena) throw() :
+			mArena(&aArena)
+		{}
+
+		template<class T2>
+		arena_allocator(const arena_allocator<T2>& aOther) throw() :
+			mArena(aOther.mArena)
+		{}
+
+		T* allocate(const size_t aCount) {
+			return mArena->allocate_array<T>(aCount);
+		}
+
+		void deallocate(T*, size_t) throw() {
+
+		}
+
+		monotonic_arena& get_arena() const throw() {
+			return *mArena;
+		}
+
+		template<class T2>
+		bool operator==(const arena_allocator<T2>& aOther) const throw() {
+			return mArena == aOther.mArena;
+		}
+
+		template<class T2>
+		bool operator!=(const arena_allocator<T2>& aOther) const throw() {
+			return mArena != aOther.mArena;
+		}
+	};
+
+#ifdef ASMITH_ARENA_PMR_AVAILABLE
+	/*!
+		\brief Adapts a monotonic_arena to std::pmr::memory_resource so that it can be used with std::pmr containers.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class arena_resource : public std::pmr::memory_resource {
+	private:
+		monotonic_arena& mArena;
+	protected:
+		void* do_allocate(size_t aBytes, size_t aAlignment) override {
+			return mArena.allocate(aBytes, aAlignment);
+		}
+
+		void do_deallocate(void*, size_t, size_t) override {
+
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& aOther) const noexcept override {
+			return this == &aOther;
+		}
+	public:
+		explicit arena_resource(monotonic_arena& aArena) throw() :
+			mArena(aArena)
+		{}
+
+		monotonic_arena& get_arena() const throw() {
+			return mArena;
+		}
+	};
+#endif
+}
+#endif
\ No newline at end of file
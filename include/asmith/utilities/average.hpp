@@ -15,73 +15,414 @@
 #define ASMITH_UTILITIES_AVERAGE_HPP
 
 #include <algorithm>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "arena.hpp"
+#include "parallel_reduction.hpp"
+#include "narrow_histogram.hpp"
 
 namespace asmith {
 
+	namespace implementation {
+		template<class T, class S>
+		inline T divide(const S aSum, const size_t aSize, std::true_type) {
+			return static_cast<T>(aSum / static_cast<S>(aSize));
+		}
+
+		template<class T, class S>
+		inline T divide(const S aSum, const size_t aSize, std::false_type) {
+			return static_cast<T>(static_cast<double>(aSum) / static_cast<double>(aSize));
+		}
+
+		template<class T, class I>
+		T mean(const I aBegin, const I aEnd, std::false_type) {
+			size_t size = 0;
+			T tmp = static_cast<T>(0);
+			for(I i = aBegin; i != aEnd; ++i, ++size) {
+				tmp += *i;
+			}
+			return tmp / static_cast<T>(size);
+		}
+
+		template<class T, class I>
+		T mean(const I aBegin, const I aEnd, std::true_type) {
+			const size_t size = static_cast<size_t>(aEnd - aBegin);
+			return divide<T>(implementation::sum(aBegin, size), size, std::integral_constant<bool, std::is_integral<T>::value>());
+		}
+	}
+
+	/*!
+		\brief Calculate the arithmetic mean of a range.
+		\detail Pointers to float, double, int32_t or int64_t use a vectorised kernel with several accumulators.
+		Floats are accumulated as double and integers as int64_t.
+		\param aBegin The first element.
+		\param aEnd The end of the range.
+		\return The mean.
+	*/
 	template<class T, class I>
 	T mean(const I aBegin, const I aEnd) {
-		size_t size = 0;
-		T tmp = static_cast<T>(0);
-		for(I i = aBegin; i != aEnd; ++i, ++size) {
-			tmp += *i;
+		return implementation::mean<T, I>(aBegin, aEnd, std::integral_constant<bool, implementation::is_reducible<I>::value>());
+	}
+
+	/*!
+		\brief Calculate the arithmetic mean of a range, optionally using several threads.
+		\detail Values are accumulated as double using pairwise summation, partial results from each thread are
+		combined in a fixed order so the result is the same on every run.
+		\param aPolicy How the work is split across threads.
+		\param aBegin The first element, must be a random access iterator.
+		\param aEnd The end of the range.
+		\return The mean.
+	*/
+	template<class T, class I>
+	T mean(const reduction_policy aPolicy, const I aBegin, const I aEnd) {
+		return static_cast<T>(implementation::compute_moments(aPolicy, aBegin, aEnd).mean);
+	}
+
+	/*!
+		\brief Calculate the arithmetic mean of a range using the threads of a pool.
+		\detail Values are accumulated as double using pairwise summation, partial results from each thread are
+		combined in a fixed order.
+		\param aPool The pool to run on.
+		\param aBegin The first element, must be a random access iterator.
+		\param aEnd The end of the range.
+		\return The mean.
+	*/
+	template<class T, class I>
+	T mean(thread_pool& aPool, const I aBegin, const I aEnd) {
+		return static_cast<T>(implementation::compute_moments(aPool, aBegin, aEnd).mean);
+	}
+
+	namespace implementation {
+		template<class T>
+		T sorted_median(const T* const aValues, const size_t aSize) {
+			const T* const mid = aValues + aSize / 2;
+			return (aSize & 1) == 0 ? (mid[-1] + mid[0]) / static_cast<T>(2) : *mid;
+		}
+
+		template<class T, class I>
+		T median(monotonic_arena& aArena, const I aBegin, const I aEnd, std::false_type) {
+			const scratch_scope scope(aArena);
+			const size_t size = static_cast<size_t>(std::distance(aBegin, aEnd));
+			T* const buf = aArena.allocate_array<T>(size);
+			std::uninitialized_copy(aBegin, aEnd, buf);
+			std::sort(buf, buf + size);
+			const T tmp = sorted_median(buf, size);
+			for(size_t i = 0; i < size; ++i) buf[i].~T();
+			return tmp;
+		}
+
+		template<class T, class I>
+		T median(monotonic_arena& aArena, const I aBegin, const I aEnd, std::true_type) {
+			const scratch_scope scope(aArena);
+			return narrow_histogram<T, arena_allocator<uint64_t>>(aBegin, aEnd, arena_allocator<uint64_t>(aArena)).median();
+		}
+
+		template<class T, class I>
+		T median(const I aBegin, const I aEnd, std::false_type) {
+			const size_t size = static_cast<size_t>(std::distance(aBegin, aEnd));
+			if(size <= SCRATCH_LIMIT / sizeof(T)) return median<T, I>(scratch_arena(), aBegin, aEnd, std::false_type());
+
+			// Too large to keep in the scratch arena after the call
+			std::vector<T> buf(aBegin, aEnd);
+			std::sort(buf.begin(), buf.end());
+			return sorted_median(buf.data(), size);
+		}
+
+		template<class T, class I>
+		T median(const I aBegin, const I aEnd, std::true_type) {
+			return median<T, I>(scratch_arena(), aBegin, aEnd, std::true_type());
 		}
-		return tmp / static_cast<T>(size);
 	}
 
+	/*!
+		\brief Calculate the median of a range.
+		\detail Integer types of 16 bits or less are counted into a histogram in O(n) instead of being copied and sorted.
+		Temporary storage comes from the calling thread's scratch arena, unless the copy would be larger than 1MB.
+		\param aBegin The first element.
+		\param aEnd The end of the range.
+		\return The median.
+	*/
 	template<class T, class I>
 	T median(const I aBegin, const I aEnd) {
-		// Initialise
-		T tmp;
-		size_t size = 0;
-		for(I i = aBegin; i != aEnd; ++i) ++size;
-		T* const buf = new T[size];
-		try {
-			// Sort instances
-			I i = aBegin;
-			for(size_t j = 0; j < size; ++j, ++i) buf[j] = *i;
-			std::sort(buf, buf+size);
-			const T* const mid = buf + size / 2;
-
-			// Calculate the median
-			tmp = (size & 1) == 0 ? (mid[-1] + mid[0]) / static_cast<T>(2) : *mid;
-		}catch (std::exception& e) {
-			delete[] buf;
-			throw e;
-		}
-		delete[] buf;
-		return tmp;
+		return implementation::median<T, I>(aBegin, aEnd, std::integral_constant<bool, implementation::is_small_domain<T>::value>());
 	}
 
+	/*!
+		\brief Calculate the median of a range, using an arena for temporary storage.
+		\detail The arena is rewound before returning, so a loop can reuse the same arena without touching the heap.
+		\param aArena The arena to allocate from.
+		\param aBegin The first element.
+		\param aEnd The end of the range.
+		\return The median.
+	*/
 	template<class T, class I>
-	T mode(const I aBegin, const I aEnd) {
-		// Initialise
-		std::pair<T, size_t> tmp;
-		size_t size = 0;
-		for(I i = aBegin; i != aEnd; ++i) ++size;
-		std::pair<T,size_t>* const buf = new std::pair<T, size_t>[size];
-		try {
-			// Count instances
-			I i = aBegin;
-			for(size_t j = 0; j < size; ++j, ++i) {
-				buf[j].first = *i;
-				buf[j].second = 1;
-				for(size_t k = 0; k < j; ++k) {
-					if(buf[j].first == buf[k].first) {
-						++buf[j].second;
-						break;
+	T median(monotonic_arena& aArena, const I aBegin, const I aEnd) {
+		return implementation::median<T, I>(aArena, aBegin, aEnd, std::integral_constant<bool, implementation::is_small_domain<T>::value>());
+	}
+
+	namespace implementation {
+		/*!
+			\brief Sort an array by sorting one run per thread and then merging pairs of runs in parallel.
+		*/
+		template<class T>
+		void parallel_sort(thread_pool& aPool, T* const aData, const size_t aSize) {
+			const size_t threads = aPool.get_concurrency();
+			if(threads == 1 || aSize < PARALLEL_MIN_SIZE) {
+				std::sort(aData, aData + aSize);
+				return;
+			}
+
+			const size_t run = (aSize + threads - 1) / threads;
+			parallel_for(aPool, 0, threads, [&](const size_t aFirst, const size_t aLast) {
+				for(size_t i = aFirst; i < aLast; ++i) {
+					const size_t begin = i * run;
+					if(begin < aSize) std::sort(aData + begin, aData + (aSize - begin < run ? aSize : begin + run));
+				}
+			}, 1);
+
+			for(size_t width = run; width < aSize; width *= 2) {
+				const size_t merges = (aSize + width * 2 - 1) / (width * 2);
+				parallel_for(aPool, 0, merges, [&](const size_t aFirst, const size_t aLast) {
+					for(size_t i = aFirst; i < aLast; ++i) {
+						const size_t begin = i * width * 2;
+						const size_t middle = aSize - begin < width ? aSize : begin + width;
+						const size_t end = aSize - middle < width ? aSize : middle + width;
+						std::inplace_merge(aData + begin, aData + middle, aData + end);
 					}
+				}, 1);
+			}
+		}
+
+		template<class T, class I>
+		T median(thread_pool& aPool, const I aBegin, const I aEnd, std::false_type) {
+			std::vector<T> buf(aBegin, aEnd);
+			const size_t size = buf.size();
+			parallel_sort(aPool, buf.data(), size);
+			const T* const mid = buf.data() + size / 2;
+			return (size & 1) == 0 ? (mid[-1] + mid[0]) / static_cast<T>(2) : *mid;
+		}
+
+		template<class T, class I>
+		T median(thread_pool& aPool, const I aBegin, const I aEnd, std::true_type) {
+			return narrow_histogram<T>(aPool, aBegin, aEnd).median();
+		}
+	}
+
+	/*!
+		\brief Calculate the median of a range using the threads of a pool.
+		\detail Integer types of 16 bits or less are counted into per-thread histograms, other types are copied and
+		sorted with a parallel merge sort.
+		\param aPool The pool to run on.
+		\param aBegin The first element, must be a random access iterator.
+		\param aEnd The end of the range.
+		\return The median.
+	*/
+	template<class T, class I>
+	T median(thread_pool& aPool, const I aBegin, const I aEnd) {
+		return implementation::median<T, I>(aPool, aBegin, aEnd, std::integral_constant<bool, implementation::is_small_domain<T>::value>());
+	}
+
+	namespace implementation {
+		/*!
+			\brief Count the number of instances of each value in a small integer domain.
+			\param aBegin The first element.
+			\param aEnd The end of the range.
+			\param aCounts A zero-initialised array with 1 << (sizeof(T) * 8) elements.
+			\param aMode Set to the first value to reach the highest count.
+			\return The number of elements counted.
+		*/
+		template<class T, class I>
+		size_t count_small_domain(const I aBegin, const I aEnd, size_t* const aCounts, T& aMode) {
+			typedef typename std::make_unsigned<T>::type unsigned_t;
+			size_t size = 0;
+			size_t best = 0;
+			for(I i = aBegin; i != aEnd; ++i, ++size) {
+				const T value = static_cast<T>(*i);
+				const size_t count = ++aCounts[static_cast<unsigned_t>(value)];
+				if(count > best) {
+					best = count;
+					aMode = value;
+				}
+			}
+			return size;
+		}
+
+		/*!
+			\brief Count the number of instances of each value in a range.
+			\param aBegin The first element.
+			\param aEnd The end of the range.
+			\param aCounts The map to add the counts to.
+			\param aMode Set to the first value to reach the highest count.
+			\return The number of elements counted.
+		*/
+		template<class T, class I, class MAP>
+		size_t count_hashed(const I aBegin, const I aEnd, MAP& aCounts, T& aMode) {
+			size_t size = 0;
+			size_t best = 0;
+			for(I i = aBegin; i != aEnd; ++i, ++size) {
+				const T value = static_cast<T>(*i);
+				const size_t count = ++aCounts[value];
+				if(count > best) {
+					best = count;
+					aMode = value;
 				}
 			}
-			
-			// Find instance with highest count
-			tmp = buf[0];
-			for(size_t j = 1; j < size; ++j) if(buf[j].second > tmp.second) tmp = buf[j];
-		}catch (std::exception& e) {
-			delete[] buf;
-			throw e;
-		}
-		delete[] buf;
-		return tmp.first;
+			return size;
+		}
+
+		template<class T, class I>
+		T mode(monotonic_arena& aArena, const I aBegin, const I aEnd, std::true_type) {
+			enum : size_t { DOMAIN_SIZE = static_cast<size_t>(1) << (sizeof(T) * 8) };
+			const scratch_scope scope(aArena);
+			size_t* const counts = aArena.allocate_array<size_t>(DOMAIN_SIZE);
+			std::fill(counts, counts + DOMAIN_SIZE, 0);
+			T tmp = static_cast<T>(0);
+			if(count_small_domain<T, I>(aBegin, aEnd, counts, tmp) == 0) throw std::invalid_argument("asmith::mode : Range is empty");
+			return tmp;
+		}
+
+		template<class T, class I>
+		T mode(monotonic_arena& aArena, const I aBegin, const I aEnd, std::false_type) {
+			typedef arena_allocator<std::pair<const T, size_t>> allocator_t;
+			const scratch_scope scope(aArena);
+			std::unordered_map<T, size_t, std::hash<T>, std::equal_to<T>, allocator_t> counts(0, std::hash<T>(), std::equal_to<T>(), allocator_t(aArena));
+			T tmp = T();
+			if(count_hashed<T, I>(aBegin, aEnd, counts, tmp) == 0) throw std::invalid_argument("asmith::mode : Range is empty");
+			return tmp;
+		}
+
+		template<class T, class I>
+		T mode(const I aBegin, const I aEnd, std::true_type) {
+			return mode<T, I>(scratch_arena(), aBegin, aEnd, std::true_type());
+		}
+
+		template<class T, class I>
+		T mode(const I aBegin, const I aEnd, std::false_type) {
+			std::unordered_map<T, size_t> counts;
+			T tmp = T();
+			if(count_hashed<T, I>(aBegin, aEnd, counts, tmp) == 0) throw std::invalid_argument("asmith::mode : Range is empty");
+			return tmp;
+		}
+
+		template<class T, class I>
+		std::vector<std::pair<T, size_t>> top_k(monotonic_arena& aArena, const I aBegin, const I aEnd, std::true_type) {
+			enum : size_t { DOMAIN_SIZE = static_cast<size_t>(1) << (sizeof(T) * 8) };
+			typedef typename std::make_unsigned<T>::type unsigned_t;
+			const scratch_scope scope(aArena);
+			size_t* const counts = aArena.allocate_array<size_t>(DOMAIN_SIZE);
+			std::fill(counts, counts + DOMAIN_SIZE, 0);
+			T ignored;
+			count_small_domain<T, I>(aBegin, aEnd, counts, ignored);
+
+			std::vector<std::pair<T, size_t>> tmp;
+			for(size_t i = 0; i < DOMAIN_SIZE; ++i) {
+				if(counts[i] != 0) tmp.push_back(std::pair<T, size_t>(static_cast<T>(static_cast<unsigned_t>(i)), counts[i]));
+			}
+			return tmp;
+		}
+
+		template<class T, class I>
+		std::vector<std::pair<T, size_t>> top_k(monotonic_arena& aArena, const I aBegin, const I aEnd, std::false_type) {
+			typedef arena_allocator<std::pair<const T, size_t>> allocator_t;
+			const scratch_scope scope(aArena);
+			std::unordered_map<T, size_t, std::hash<T>, std::equal_to<T>, allocator_t> counts(0, std::hash<T>(), std::equal_to<T>(), allocator_t(aArena));
+			T ignored;
+			count_hashed<T, I>(aBegin, aEnd, counts, ignored);
+			return std::vector<std::pair<T, size_t>>(counts.begin(), counts.end());
+		}
+
+		template<class T, class I>
+		std::vector<std::pair<T, size_t>> top_k(const I aBegin, const I aEnd, std::true_type) {
+			return top_k<T, I>(scratch_arena(), aBegin, aEnd, std::true_type());
+		}
+
+		template<class T, class I>
+		std::vector<std::pair<T, size_t>> top_k(const I aBegin, const I aEnd, std::false_type) {
+			std::unordered_map<T, size_t> counts;
+			T ignored;
+			count_hashed<T, I>(aBegin, aEnd, counts, ignored);
+			return std::vector<std::pair<T, size_t>>(counts.begin(), counts.end());
+		}
+
+		/*!
+			\brief Order value and count pairs from most to least common and keep the first aK.
+		*/
+		template<class T>
+		void select_top_k(std::vector<std::pair<T, size_t>>& aValues, const size_t aK) {
+			const auto compare = [](const std::pair<T, size_t>& a, const std::pair<T, size_t>& b)->bool {
+				return a.second > b.second;
+			};
+			if(aK < aValues.size()) {
+				std::partial_sort(aValues.begin(), aValues.begin() + aK, aValues.end(), compare);
+				aValues.resize(aK);
+			}else {
+				std::sort(aValues.begin(), aValues.end(), compare);
+			}
+		}
+	}
+
+	/*!
+		\brief Find the most common value in a range.
+		\detail Runs in linear time. Integer types of 16 bits or less are counted with a flat array in the calling
+		thread's scratch arena, other types with std::unordered_map. If several values share the highest count then the first value to reach that count is returned.
+		\param aBegin The first element.
+		\param aEnd The end of the range.
+		\return The most common value.
+		\throw std::invalid_argument If the range is empty.
+	*/
+	template<class T, class I>
+	T mode(const I aBegin, const I aEnd) {
+		return implementation::mode<T, I>(aBegin, aEnd, std::integral_constant<bool, implementation::is_small_domain<T>::value>());
+	}
+
+	/*!
+		\brief Find the most common value in a range, using an arena for the counts.
+		\detail The arena is rewound before returning, so a loop can reuse the same arena without touching the heap.
+		\param aArena The arena to allocate from.
+		\param aBegin The first element.
+		\param aEnd The end of the range.
+		\return The most common value.
+		\throw std::invalid_argument If the range is empty.
+	*/
+	template<class T, class I>
+	T mode(monotonic_arena& aArena, const I aBegin, const I aEnd) {
+		return implementation::mode<T, I>(aArena, aBegin, aEnd, std::integral_constant<bool, implementation::is_small_domain<T>::value>());
+	}
+
+	/*!
+		\brief Find the most common values in a range.
+		\detail Runs in linear time plus O(u log k) for u unique values.
+		\param aBegin The first element.
+		\param aEnd The end of the range.
+		\param aK The maximum number of values to return.
+		\return Up to aK pairs of value and count, ordered from most to least common.
+	*/
+	template<class T, class I>
+	std::vector<std::pair<T, size_t>> top_k(const I aBegin, const I aEnd, const size_t aK) {
+		std::vector<std::pair<T, size_t>> tmp = implementation::top_k<T, I>(aBegin, aEnd, std::integral_constant<bool, implementation::is_small_domain<T>::value>());
+		implementation::select_top_k(tmp, aK);
+		return tmp;
+	}
+
+	/*!
+		\brief Find the most common values in a range, using an arena for the counts.
+		\detail The arena is rewound before returning, so a loop can reuse the same arena without touching the heap
+		for anything except the returned vector.
+		\param aArena The arena to allocate from.
+		\param aBegin The first element.
+		\param aEnd The end of the range.
+		\param aK The maximum number of values to return.
+		\return Up to aK pairs of value and count, ordered from most to least common.
+	*/
+	template<class T, class I>
+	std::vector<std::pair<T, size_t>> top_k(monotonic_arena& aArena, const I aBegin, const I aEnd, const size_t aK) {
+		std::vector<std::pair<T, size_t>> tmp = implementation::top_k<T, I>(aArena, aBegin, aEnd, std::integral_constant<bool, implementation::is_small_domain<T>::value>());
+		implementation::select_top_k(tmp, aK);
+		return tmp;
 	}
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,244 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_BATCH_STATISTICS_HPP
+#define ASMITH_UTILITIES_BATCH_STATISTICS_HPP
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "reduction.hpp"
+
+namespace asmith {
+
+	/*!
+		\brief Summary statistics of one series in a batch.
+		\tparam T The type of the values in the series.
+	*/
+	template<class T>
+	struct column_summary {
+		moments<double> totals;	//!< Count, mean and sum of squared differences
+		T min;						//!< Smallest value
+		T max;						//!< Largest value
+
+		double mean() const throw() {
+			return totals.mean;
+		}
+
+		double variance(const bool aSample = false) const throw() {
+			return totals.variance(aSample);
+		}
+
+		double standard_deviation(const bool aSample = false) const throw() {
+			return std::sqrt(totals.variance(aSample));
+		}
+	};
+
+	namespace implementation {
+		enum : size_t {
+			BATCH_ROW_BLOCK = 64,	//!< Rows processed together when summarising a row-major matrix
+			COVARIANCE_ROW_BLOCK = 256,	//!< Rows centred and buffered together when calculating a covariance matrix
+			COVARIANCE_TILE = 32	//!< Columns in each tile of the covariance matrix
+		};
+
+		template<class T>
+		column_summary<T> summarise_column(const T* const aValues, const size_t aSize) {
+			column_summary<T> tmp;
+			tmp.min = std::numeric_limits<T>::max();
+			tmp.max = std::numeric_limits<T>::lowest();
+			for(size_t i = 0; i < aSize; i += MOMENTS_BLOCK_SIZE) {
+				// The block is still in L1 cache when the min and max are found, so the column is only streamed once
+				const size_t size = aSize - i < MOMENTS_BLOCK_SIZE ? aSize - i : MOMENTS_BLOCK_SIZE;
+				const T* const block = aValues + i;
+				tmp.totals.merge(block_moments(block, size, std::integral_constant<bool, is_reducible<const T*>::value>()));
+				for(size_t j = 0; j < size; ++j) {
+					tmp.min = block[j] < tmp.min ? block[j] : tmp.min;
+					tmp.max = block[j] > tmp.max ? block[j] : tmp.max;
+				}
+			}
+			return tmp;
+		}
+
+		inline double dot(const double* const aA, const double* const aB, const size_t aSize) throw() {
+			double acc[4] = { 0.0, 0.0, 0.0, 0.0 };
+			size_t i = 0;
+			for(const size_t end = aSize - aSize % 4; i < end; i += 4) {
+				acc[0] += aA[i] * aB[i];
+				acc[1] += aA[i + 1] * aB[i + 1];
+				acc[2] += aA[i + 2] * aB[i + 2];
+				acc[3] += aA[i + 3] * aB[i + 3];
+			}
+			for(; i < aSize; ++i) acc[0] += aA[i] * aB[i];
+			return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+		}
+	}
+
+	/*!
+		\brief Calculate the count, mean, variance, min and max of many series at once.
+		\detail Each series is read once, the moments and range are accumulated in the same pass.
+		\param aColumns An array of pointers to each series (structure of arrays layout).
+		\param aColumnCount The number of series.
+		\param aRows The number of values in each series.
+		\return The summary of each series.
+	*/
+	template<class T>
+	std::vector<column_summary<T>> summarise_columns(const T* const* const aColumns, const size_t aColumnCount, const size_t aRows) {
+		std::vector<column_summary<T>> tmp(aColumnCount);
+		for(size_t i = 0; i < aColumnCount; ++i) tmp[i] = implementation::summarise_column<T>(aColumns[i], aRows);
+		return tmp;
+	}
+
+	/*!
+		\brief Calculate the count, mean, variance, min and max of each column of a row-major matrix.
+		\detail Rows are processed in blocks, the inner loop runs across contiguous columns so it can be vectorised.
+		Each block is summed around its first row and merged into the totals with moments::merge.
+		\param aData The first row of the matrix.
+		\param aRows The number of rows (samples).
+		\param aColumns The number of columns (series).
+		\param aStride The distance between the start of each row, in elements.
+		\return The summary of each column.
+	*/
+	template<class T>
+	std::vector<column_summary<T>> summarise_rows(const T* const aData, const size_t aRows, const size_t aColumns, const size_t aStride) {
+		std::vector<column_summary<T>> tmp(aColumns);
+		std::vector<double> shift(aColumns);
+		std::vector<double> sum(aColumns);
+		std::vector<double> sum_squares(aColumns);
+		std::vector<T> min(aColumns, std::numeric_limits<T>::max());
+		std::vector<T> max(aColumns, std::numeric_limits<T>::lowest());
+
+		for(size_t r = 0; r < aRows; r += implementation::BATCH_ROW_BLOCK) {
+			const size_t rows = aRows - r < implementation::BATCH_ROW_BLOCK ? aRows - r : implementation::BATCH_ROW_BLOCK;
+			const T* const first = aData + r * aStride;
+			for(size_t c = 0; c < aColumns; ++c) {
+				shift[c] = static_cast<double>(first[c]);
+				sum[c] = 0.0;
+				sum_squares[c] = 0.0;
+			}
+
+			for(size_t i = 0; i < rows; ++i) {
+				const T* const row = first + i * aStride;
+				double* const s = sum.data();
+				double* const q = sum_squares.data();
+				const double* const k = shift.data();
+				T* const mn = min.data();
+				T* const mx = max.data();
+				for(size_t c = 0; c < aColumns; ++c) {
+					const T x = row[c];
+					const double d = static_cast<double>(x) - k[c];
+					s[c] += d;
+					q[c] += d * d;
+					mn[c] = x < mn[c] ? x : mn[c];
+					mx[c] = x > mx[c] ? x : mx[c];
+				}
+			}
+
+			const double n = static_cast<double>(rows);
+			for(size_t c = 0; c < aColumns; ++c) {
+				const double m2 = sum_squares[c] - sum[c] * sum[c] / n;
+				tmp[c].totals.merge(moments<double>(rows, shift[c] + sum[c] / n, m2 < 0.0 ? 0.0 : m2));
+			}
+		}
+
+		for(size_t c = 0; c < aColumns; ++c) {
+			tmp[c].min = min[c];
+			tmp[c].max = max[c];
+		}
+		return tmp;
+	}
+
+	/*!
+		\brief Calculate the covariance matrix of many series.
+		\detail Uses two passes for accuracy, the first finds the mean of each series. In the second pass blocks of
+		rows are centred into a buffer, then the products are accumulated tile by tile so that both sides of each
+		tile stay in cache.
+		\param aColumns An array of pointers to each series (structure of arrays layout).
+		\param aColumnCount The number of series.
+		\param aRows The number of values in each series.
+		\param aSample True for the sample covariance (n - 1), false for the population covariance (n).
+		\return A aColumnCount x aColumnCount row-major matrix.
+	*/
+	template<class T>
+	std::vector<double> covariance_matrix(const T* const* const aColumns, const size_t aColumnCount, const size_t aRows, const bool aSample = true) {
+		enum : size_t {
+			BLOCK = implementation::COVARIANCE_ROW_BLOCK,
+			TILE = implementation::COVARIANCE_TILE
+		};
+
+		std::vector<double> tmp(aColumnCount * aColumnCount, 0.0);
+		std::vector<double> means(aColumnCount);
+		for(size_t i = 0; i < aColumnCount; ++i) means[i] = implementation::compute_moments(aColumns[i], aRows).mean;
+
+		std::vector<double> buffer(aColumnCount * BLOCK);
+		for(size_t r = 0; r < aRows; r += BLOCK) {
+			const size_t rows = aRows - r < BLOCK ? aRows - r : BLOCK;
+
+			// Centre the block, each series is contiguous in the buffer
+			for(size_t c = 0; c < aColumnCount; ++c) {
+				const T* const src = aColumns[c] + r;
+				double* const dst = buffer.data() + c * BLOCK;
+				const double mean = means[c];
+				for(size_t i = 0; i < rows; ++i) dst[i] = static_cast<double>(src[i]) - mean;
+			}
+
+			// Accumulate the upper triangle one tile at a time
+			for(size_t ti = 0; ti < aColumnCount; ti += TILE) {
+				const size_t ti_end = std::min<size_t>(ti + TILE, aColumnCount);
+				for(size_t tj = ti; tj < aColumnCount; tj += TILE) {
+					const size_t tj_end = std::min<size_t>(tj + TILE, aColumnCount);
+					for(size_t i = ti; i < ti_end; ++i) {
+						const double* const a = buffer.data() + i * BLOCK;
+						double* const out = tmp.data() + i * aColumnCount;
+						for(size_t j = std::max(i, tj); j < tj_end; ++j) {
+							out[j] += implementation::dot(a, buffer.data() + j * BLOCK, rows);
+						}
+					}
+				}
+			}
+		}
+
+		const double divisor = static_cast<double>(aSample ? aRows - 1 : aRows);
+		for(size_t i = 0; i < aColumnCount; ++i) {
+			for(size_t j = i; j < aColumnCount; ++j) {
+				const double value = tmp[i * aColumnCount + j] / divisor;
+				tmp[i * aColumnCount + j] = value;
+				tmp[j * aColumnCount + i] = value;
+			}
+		}
+		return tmp;
+	}
+
+	/*!
+		\brief Calculate the Pearson correlation matrix of many series.
+		\param aColumns An array of pointers to each series (structure of arrays layout).
+		\param aColumnCount The number of series.
+		\param aRows The number of values in each series.
+		\return A aColumnCount x aColumnCount row-major matrix, entries involving a constant series are NaN.
+		\see covariance_matrix
+	*/
+	template<class T>
+	std::vector<double> correlation_matrix(const T* const* const aColumns, const size_t aColumnCount, const size_t aRows) {
+		std::vector<double> tmp = covariance_matrix<T>(aColumns, aColumnCount, aRows, true);
+		std::vector<double> scale(aColumnCount);
+		for(size_t i = 0; i < aColumnCount; ++i) {
+			const double variance = tmp[i * aColumnCount + i];
+			scale[i] = variance > 0.0 ? 1.0 / std::sqrt(variance) : std::numeric_limits<double>::quiet_NaN();
+		}
+		for(size_t i = 0; i < aColumnCount; ++i) {
+			for(size_t j = 0; j < aColumnCount; ++j) tmp[i * aColumnCount + j] *= scale[i] * scale[j];
+		}
+		return tmp;
+	}
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,253 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_BENCHMARK_HPP
+#define ASMITH_UTILITIES_BENCHMARK_HPP
+
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "tsc_timer.hpp"
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace asmith {
+
+	/*!
+		\brief Prevent the compiler from optimising away the calculation of a value.
+		\detail The value is treated as if it is read by an unknown instruction.
+	*/
+	template<class T>
+	inline void do_not_optimise(const T& aValue) throw() {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(aValue) : "memory");
+#else
+		static volatile const void* SINK;
+		SINK = &aValue;
+		_ReadWriteBarrier();
+#endif
+	}
+
+	/*!
+		\brief Prevent the compiler from reordering or removing memory accesses across this point.
+		\detail All pending writes are treated as if they are read by an unknown instruction.
+	*/
+	inline void clobber_memory() throw() {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : : "memory");
+#else
+		_ReadWriteBarrier();
+#endif
+	}
+
+	/*!
+		\brief Passed to a benchmark function to control one timed run.
+		\detail The function must perform the work get_iterations() times. Setup that should not be measured can be
+		excluded with pause_timing and resume_timing.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class benchmark_state {
+	private:
+		tsc_timer<std::chrono::nanoseconds, true> mTimer;
+		const uint64_t mIterations;
+		const uint64_t mParameter;
+		uint64_t mBytesPerIteration;
+		uint64_t mItemsPerIteration;
+	public:
+		benchmark_state(const uint64_t aIterations, const uint64_t aParameter) throw() :
+			mIterations(aIterations),
+			mParameter(aParameter),
+			mBytesPerIteration(0),
+			mItemsPerIteration(0)
+		{}
+
+		/*!
+			\brief Get the number of times that the work must be performed.
+		*/
+		inline uint64_t get_iterations() const throw() {
+			return mIterations;
+		}
+
+		/*!
+			\brief Get the input size that the benchmark was registered with, or 0.
+		*/
+		inline uint64_t get_parameter() const throw() {
+			return mParameter;
+		}
+
+		/*!
+			\brief Set the number of bytes processed by each iteration, used to report throughput.
+		*/
+		inline void set_bytes_per_iteration(const uint64_t aBytes) throw() {
+			mBytesPerIteration = aBytes;
+		}
+
+		/*!
+			\brief Set the number of items processed by each iteration, used to report throughput.
+		*/
+		inline void set_items_per_iteration(const uint64_t aItems) throw() {
+			mItemsPerIteration = aItems;
+		}
+
+		inline uint64_t get_bytes_per_iteration() const throw() {
+			return mBytesPerIteration;
+		}
+
+		inline uint64_t get_items_per_iteration() const throw() {
+			return mItemsPerIteration;
+		}
+
+		/*!
+			\brief Stop measuring time, eg. while resetting the input.
+		*/
+		inline void pause_timing() throw() {
+			mTimer.pause();
+		}
+
+		/*!
+			\brief Start measuring time again after pause_timing.
+		*/
+		inline void resume_timing() throw() {
+			mTimer.resume();
+		}
+
+		/*!
+			\brief Used by the harness to time the benchmark function.
+		*/
+		inline timer_interface& get_timer() throw() {
+			return mTimer;
+		}
+
+		/*!
+			\brief Get the measured time in ticks.
+		*/
+		inline uint64_t get_elapsed_ticks() const throw() {
+			return mTimer.get_elapsed_ticks();
+		}
+	};
+
+	/*!
+		\brief Controls how each benchmark is run.
+	*/
+	struct benchmark_options {
+		std::chrono::milliseconds warm_up;		//!< Time spent running the benchmark before measuring it
+		std::chrono::milliseconds min_time;		//!< Each repeat runs for at least this long, the iteration count is calibrated to reach it
+		uint32_t repeats;						//!< The number of measured runs
+		double outlier_fence;					//!< Repeats outside of [Q1 - k * IQR, Q3 + k * IQR] are rejected, 0 disables rejection
+		double confidence;						//!< Confidence level of the reported intervals, 0.9, 0.95 or 0.99
+		std::string filter;						//!< Only benchmarks whose name contains this are run
+
+		benchmark_options() :
+			warm_up(50),
+			min_time(20),
+			repeats(15),
+			outlier_fence(1.5),
+			confidence(0.95)
+		{}
+	};
+
+	/*!
+		\brief The measurements of one benchmark with one parameter.
+		\detail Times are per iteration, throughputs are per second. The intervals are the half width of the confidence interval of the mean.
+	*/
+	struct benchmark_result {
+		std::string name;
+		uint64_t parameter;
+		uint64_t iterations;		//!< Iterations per repeat
+		uint32_t repeats;			//!< Repeats used in the statistics
+		uint32_t rejected;			//!< Repeats rejected as outliers
+		double mean_ns;
+		double median_ns;
+		double standard_deviation_ns;
+		double min_ns;
+		double max_ns;
+		double interval_ns;
+		double bytes_per_second;	//!< 0 if the benchmark did not set the bytes per iteration
+		double bytes_per_second_interval;
+		double items_per_second;	//!< 0 if the benchmark did not set the items per iteration
+		double items_per_second_interval;
+	};
+
+	/*!
+		\brief A collection of benchmarks that can be run and reported together.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class benchmark_suite {
+	public:
+		typedef std::function<void(benchmark_state&)> function;
+	private:
+		struct entry {
+			std::string name;
+			function fn;
+			std::vector<uint64_t> parameters;
+		};
+
+		std::vector<entry> mBenchmarks;
+	public:
+		/*!
+			\brief Add a benchmark.
+			\param aName The name of the benchmark.
+			\param aFunction The function to measure.
+			\param aParameters The input sizes to run it with, it is run once with parameter 0 if this is empty.
+		*/
+		void add(const std::string& aName, function aFunction, std::vector<uint64_t> aParameters = std::vector<uint64_t>());
+
+		/*!
+			\brief Measure one benchmark function.
+		*/
+		static benchmark_result run(const std::string& aName, const function& aFunction, const uint64_t aParameter, const benchmark_options& aOptions);
+
+		/*!
+			\brief Measure every benchmark that matches the filter.
+			\param aProgress If not null, each result is written in the human readable format as soon as it is available.
+		*/
+		std::vector<benchmark_result> run(const benchmark_options& aOptions, std::ostream* aProgress = nullptr) const;
+
+		/*!
+			\brief Write results as an aligned text table.
+		*/
+		static void write_text(std::ostream& aStream, const std::vector<benchmark_result>& aResults);
+
+		/*!
+			\brief Write the column headers of the text table.
+		*/
+		static void write_text_header(std::ostream& aStream);
+
+		/*!
+			\brief Write one row of the text table.
+		*/
+		static void write_text(std::ostream& aStream, const benchmark_result& aResult);
+
+		/*!
+			\brief Write results as a JSON document.
+		*/
+		static void write_json(std::ostream& aStream, const std::vector<benchmark_result>& aResults);
+
+		/*!
+			\brief Run the suite with options read from the command line and write the results to std::cout.
+			\detail Recognised arguments are --filter=TEXT, --repeats=N, --min-time=MS, --warm-up=MS, --json and --help.
+			\return The exit code for main.
+		*/
+		int main(int aArgc, char** aArgv) const;
+	};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_BIT_OPERATIONS_HPP
+#define ASMITH_UTILITIES_BIT_OPERATIONS_HPP
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace asmith {
+
+	namespace implementation {
+		/*!
+			\brief Count the leading zero bits of a non-zero value.
+		*/
+		inline int count_leading_zeros(const uint64_t aValue) throw() {
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_clzll(aValue);
+#elif defined(_MSC_VER) && defined(_M_X64)
+			unsigned long index;
+			_BitScanReverse64(&index, aValue);
+			return 63 - static_cast<int>(index);
+#else
+			int count = 0;
+			for(uint64_t mask = 1ULL << 63; (aValue & mask) == 0; mask >>= 1) ++count;
+			return count;
+#endif
+		}
+
+		/*!
+			\brief Count the trailing zero bits of a non-zero value.
+		*/
+		inline int count_trailing_zeros(const uint64_t aValue) throw() {
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_ctzll(aValue);
+#elif defined(_MSC_VER) && defined(_M_X64)
+			unsigned long index;
+			_BitScanForward64(&index, aValue);
+			return static_cast<int>(index);
+#else
+			int count = 0;
+			for(uint64_t mask = 1; (aValue & mask) == 0; mask <<= 1) ++count;
+			return count;
+#endif
+		}
+
+		/*!
+			\brief Count the set bits of a value.
+		*/
+		inline int population_count(const uint64_t aValue) throw() {
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_popcountll(aValue);
+#else
+			uint64_t x = aValue - ((aValue >> 1) & 0x5555555555555555ULL);
+			x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+			x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+			return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+		}
+	}
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,241 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_CONCURRENT_TIMER_HPP
+#define ASMITH_UTILITIES_CONCURRENT_TIMER_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include "thread_index.hpp"
+#include "tsc_timer.hpp"
+
+namespace asmith {
+
+	namespace implementation {
+		enum : size_t {
+			CONCURRENT_TIMER_PADDING = 128	//!< Stride between shards, so that no two shards' members share a cache line regardless of alignment
+		};
+	}
+
+	/*!
+		\brief A timer that can be entered by many threads at the same time.
+		\detail Measures the total busy time (the sum of the durations of all sections), the number of threads currently
+		inside a section and the wall time during which at least one thread was inside a section. busy / wall gives the
+		average parallelism of a phase.
+		\n Each thread updates its own cache line padded shard. Shards are grouped and a group counter is only modified
+		when the first thread in the group enters or the last one leaves, the shared root counter is only modified when
+		the first group becomes active or the last one becomes idle. While a parallel phase is running most start/stop
+		calls therefore touch only the calling thread's shard and its group.
+		\n Sections entered by the same thread may nest, each is counted towards the busy time.
+		Statistics read while sections are running are a snapshot and may be slightly inconsistent with each other.
+		\tparam FORMAT The measurement unit of the timer, can be any std::chrono::duration class. Default value is nanoseconds
+		\tparam SHARDS The number of per-thread shards, threads beyond this share shards.
+		\tparam GROUP_SIZE The number of shards that share a group counter.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class FORMAT = std::chrono::nanoseconds, size_t SHARDS = 64, size_t GROUP_SIZE = 8>
+	class concurrent_timer {
+	public:
+		/*!
+			\brief Returned by start and passed back to stop.
+		*/
+		struct section {
+			uint64_t begin;		//!< tsc_clock tick count when the section was entered
+			uint32_t shard;		//!< The shard of the thread that entered the section
+		};
+	private:
+		enum : size_t {
+			GROUPS = (SHARDS + GROUP_SIZE - 1) / GROUP_SIZE
+		};
+
+		struct shard {
+			std::atomic<uint64_t> busy;		//!< Ticks spent in completed sections
+			std::atomic<uint64_t> sections;	//!< Number of completed sections
+			std::atomic<uint32_t> active;	//!< Number of sections currently running
+			uint8_t padding[implementation::CONCURRENT_TIMER_PADDING - sizeof(std::atomic<uint64_t>) * 2 - sizeof(std::atomic<uint32_t>)];
+		};
+
+		struct group {
+			std::atomic<uint32_t> active;	//!< Number of active shards in the group
+			uint8_t padding[implementation::CONCURRENT_TIMER_PADDING - sizeof(std::atomic<uint32_t>)];
+		};
+
+		shard mShards[SHARDS];
+		group mGroups[GROUPS];
+		std::atomic<uint32_t> mActiveGroups;	//!< Number of active groups
+		std::atomic<int64_t> mWallTicks;		//!< Sum of the idle to active transition times subtracted from the active to idle times
+
+		concurrent_timer(const concurrent_timer&) = delete;
+		concurrent_timer& operator=(const concurrent_timer&) = delete;
+	public:
+		/*!
+			\brief Create a new timer.
+		*/
+		concurrent_timer() throw() :
+			mActiveGroups(0),
+			mWallTicks(0)
+		{
+			reset();
+		}
+
+		/*!
+			\brief Enter a section.
+			\return The token that must be passed to stop, on the same thread.
+		*/
+		inline section start() throw() {
+			section tmp;
+			tmp.shard = implementation::thread_index() % SHARDS;
+			tmp.begin = tsc_clock::now();
+			if(mShards[tmp.shard].active.fetch_add(1, std::memory_order_acq_rel) == 0) {
+				if(mGroups[tmp.shard / GROUP_SIZE].active.fetch_add(1, std::memory_order_acq_rel) == 0) {
+					if(mActiveGroups.fetch_add(1, std::memory_order_acq_rel) == 0) {
+						mWallTicks.fetch_sub(static_cast<int64_t>(tmp.begin), std::memory_order_relaxed);
+					}
+				}
+			}
+			return tmp;
+		}
+
+		/*!
+			\brief Leave a section.
+			\param aSection The value returned by the matching call to start.
+		*/
+		inline void stop(const section aSection) throw() {
+			const uint64_t end = tsc_clock::now();
+			shard& s = mShards[aSection.shard];
+			s.busy.fetch_add(end - aSection.begin, std::memory_order_relaxed);
+			s.sections.fetch_add(1, std::memory_order_relaxed);
+			if(s.active.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				if(mGroups[aSection.shard / GROUP_SIZE].active.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					if(mActiveGroups.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+						mWallTicks.fetch_add(static_cast<int64_t>(end), std::memory_order_relaxed);
+					}
+				}
+			}
+		}
+
+		/*!
+			\brief Clear all statistics.
+			\detail Must not be called while any thread is inside a section.
+		*/
+		void reset() throw() {
+			for(shard& s : mShards) {
+				s.busy.store(0, std::memory_order_relaxed);
+				s.sections.store(0, std::memory_order_relaxed);
+				s.active.store(0, std::memory_order_relaxed);
+			}
+			for(group& g : mGroups) g.active.store(0, std::memory_order_relaxed);
+			mActiveGroups.store(0, std::memory_order_relaxed);
+			mWallTicks.store(0, std::memory_order_release);
+		}
+
+		/*!
+			\brief Get the number of sections that are currently running.
+		*/
+		uint32_t get_active_count() const throw() {
+			uint32_t tmp = 0;
+			for(const shard& s : mShards) tmp += s.active.load(std::memory_order_relaxed);
+			return tmp;
+		}
+
+		/*!
+			\brief Check if any thread is inside a section.
+		*/
+		bool is_active() const throw() {
+			return mActiveGroups.load(std::memory_order_acquire) != 0;
+		}
+
+		/*!
+			\brief Get the number of completed sections.
+		*/
+		uint64_t get_section_count() const throw() {
+			uint64_t tmp = 0;
+			for(const shard& s : mShards) tmp += s.sections.load(std::memory_order_relaxed);
+			return tmp;
+		}
+
+		/*!
+			\brief Get the sum of the durations of all completed sections, in ticks.
+		*/
+		uint64_t get_busy_ticks() const throw() {
+			uint64_t tmp = 0;
+			for(const shard& s : mShards) tmp += s.busy.load(std::memory_order_relaxed);
+			return tmp;
+		}
+
+		/*!
+			\brief Get the time during which at least one thread was inside a section, in ticks.
+			\detail Includes the time so far if a section is currently running.
+		*/
+		uint64_t get_wall_ticks() const throw() {
+			const bool active = is_active();
+			int64_t tmp = mWallTicks.load(std::memory_order_relaxed);
+			if(active) tmp += static_cast<int64_t>(tsc_clock::now());
+			return tmp < 0 ? 0 : static_cast<uint64_t>(tmp);
+		}
+
+		/*!
+			\brief Get the sum of the durations of all completed sections.
+			\return The busy time in FORMAT units.
+		*/
+		int64_t get_busy_time() const throw() {
+			return tsc_clock::to_duration<FORMAT>(get_busy_ticks());
+		}
+
+		/*!
+			\brief Get the time during which at least one thread was inside a section.
+			\return The wall time in FORMAT units.
+		*/
+		int64_t get_wall_time() const throw() {
+			return tsc_clock::to_duration<FORMAT>(get_wall_ticks());
+		}
+
+		/*!
+			\brief Get the average number of threads that were inside a section while any thread was.
+			\return busy time / wall time, or 0 if no time has been measured.
+		*/
+		double get_utilisation() const throw() {
+			const uint64_t wall = get_wall_ticks();
+			return wall == 0 ? 0.0 : static_cast<double>(get_busy_ticks()) / static_cast<double>(wall);
+		}
+	};
+
+	/*!
+		\brief Enters a section of a concurrent_timer when it is created and leaves it when it is destroyed.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class TIMER>
+	class scoped_concurrent_section {
+	private:
+		TIMER& mTimer;
+		const typename TIMER::section mSection;
+
+		scoped_concurrent_section(const scoped_concurrent_section&) = delete;
+		scoped_concurrent_section& operator=(const scoped_concurrent_section&) = delete;
+	public:
+		scoped_concurrent_section(TIMER& aTimer) throw() :
+			mTimer(aTimer),
+			mSection(aTimer.start())
+		{}
+
+		~scoped_concurrent_section() throw() {
+			mTimer.stop(mSection);
+		}
+	};
+}
+#endif
\ No newline at end of file
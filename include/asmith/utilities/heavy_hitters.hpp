@@ -0,0 +1,334 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_HEAVY_HITTERS_HPP
+#define ASMITH_UTILITIES_HEAVY_HITTERS_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace asmith {
+
+	namespace implementation {
+		/*!
+			\brief Scramble the bits of a hash value so that weak hash functions (eg. std::hash<int>) can be used to index tables.
+		*/
+		inline uint64_t mix_hash(uint64_t aHash) throw() {
+			aHash ^= aHash >> 33;
+			aHash *= 0xFF51AFD7ED558CCDULL;
+			aHash ^= aHash >> 33;
+			aHash *= 0xC4CEB9FE1A85EC53ULL;
+			aHash ^= aHash >> 33;
+			return aHash;
+		}
+	}
+
+	/*!
+		\brief Streaming top-k summary using the Space-Saving algorithm.
+		\detail Tracks at most capacity() values. Any value with a true frequency greater than total() / capacity() is
+		guaranteed to be tracked. Each tracked count over-estimates the true frequency by at most its error term.
+		Counters are kept in a min-heap so an update costs O(log capacity). When compiled as C++17 the index node of an evicted
+		value is reused for its replacement, so no memory is allocated once the summary is full (beyond any allocation made by
+		copying T itself). Earlier standards free and allocate one index node per eviction.
+		\tparam T The type of value to count.
+		\tparam HASH The hash function for T.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T, class HASH = std::hash<T>>
+	class space_saving {
+	public:
+		/*!
+			\brief A tracked value.
+		*/
+		struct counter {
+			T value;			//!< The value being counted
+			uint64_t count;		//!< Upper bound of the frequency of value
+			uint64_t error;		//!< Maximum over-estimation of count
+		};
+	private:
+		std::vector<counter> mCounters;					//!< Min-heap ordered by count
+		std::unordered_map<T, size_t, HASH> mIndex;		//!< Maps a value to its position in mCounters
+		size_t mCapacity;								//!< Maximum number of counters
+		uint64_t mTotal;								//!< Sum of all counts added
+
+		void set(const size_t aPos, const counter& aCounter) {
+			mCounters[aPos] = aCounter;
+			mIndex[aCounter.value] = aPos;
+		}
+
+		void sift_down(size_t aPos) {
+			const size_t size = mCounters.size();
+			const counter tmp = mCounters[aPos];
+			while(true) {
+				size_t child = aPos * 2 + 1;
+				if(child >= size) break;
+				if(child + 1 < size && mCounters[child + 1].count < mCounters[child].count) ++child;
+				if(tmp.count <= mCounters[child].count) break;
+				set(aPos, mCounters[child]);
+				aPos = child;
+			}
+			set(aPos, tmp);
+		}
+
+		void sift_up(size_t aPos) {
+			const counter tmp = mCounters[aPos];
+			while(aPos > 0) {
+				const size_t parent = (aPos - 1) / 2;
+				if(mCounters[parent].count <= tmp.count) break;
+				set(aPos, mCounters[parent]);
+				aPos = parent;
+			}
+			set(aPos, tmp);
+		}
+	public:
+		/*!
+			\brief Create a new summary.
+			\param aCapacity The maximum number of values to track, must be greater than 0.
+		*/
+		explicit space_saving(const size_t aCapacity) :
+			mCapacity(aCapacity == 0 ? 1 : aCapacity),
+			mTotal(0)
+		{
+			mCounters.reserve(mCapacity);
+			mIndex.reserve(mCapacity);
+		}
+
+		/*!
+			\brief Count an instance of a value.
+			\param aValue The value to count.
+			\param aCount The number of instances to add.
+		*/
+		void add(const T& aValue, const uint64_t aCount = 1) {
+			mTotal += aCount;
+			const auto i = mIndex.find(aValue);
+			if(i != mIndex.end()) {
+				mCounters[i->second].count += aCount;
+				sift_down(i->second);
+			}else if(mCounters.size() < mCapacity) {
+				mCounters.push_back(counter{aValue, aCount, 0});
+				mIndex.emplace(aValue, mCounters.size() - 1);
+				sift_up(mCounters.size() - 1);
+			}else {
+				// Replace the least frequent value
+				const uint64_t min = mCounters[0].count;
+#if __cplusplus >= 201703L
+				auto node = mIndex.extract(mCounters[0].value);
+				node.key() = aValue;
+				mIndex.insert(std::move(node));
+#else
+				mIndex.erase(mCounters[0].value);
+#endif
+				set(0, counter{aValue, min + aCount, min});
+				sift_down(0);
+			}
+		}
+
+		/*!
+			\brief Combine the counts from another summary into this one.
+			\detail Uses the merge procedure from Agarwal et al. "Mergeable Summaries", the result has the same error guarantees
+			as a single summary over both streams.
+			\param aOther The summary to merge.
+		*/
+		void merge(const space_saving& aOther) {
+			const uint64_t min_a = mCounters.size() < mCapacity ? 0 : mCounters[0].count;
+			const uint64_t min_b = aOther.mCounters.size() < aOther.mCapacity ? 0 : aOther.mCounters[0].count;
+
+			std::vector<counter> tmp = mCounters;
+			for(counter& i : tmp) {
+				const auto j = aOther.mIndex.find(i.value);
+				if(j == aOther.mIndex.end()) {
+					i.count += min_b;
+					i.error += min_b;
+				}else {
+					i.count += aOther.mCounters[j->second].count;
+					i.error += aOther.mCounters[j->second].error;
+				}
+			}
+			for(const counter& i : aOther.mCounters) {
+				if(mIndex.find(i.value) == mIndex.end()) tmp.push_back(counter{i.value, i.count + min_a, i.error + min_a});
+			}
+
+			// Keep the largest counters
+			if(tmp.size() > mCapacity) {
+				std::nth_element(tmp.begin(), tmp.begin() + mCapacity, tmp.end(), [](const counter& a, const counter& b)->bool {
+					return a.count > b.count;
+				});
+				tmp.resize(mCapacity);
+			}
+
+			mTotal += aOther.mTotal;
+			mCounters.clear();
+			mIndex.clear();
+			for(const counter& i : tmp) {
+				mCounters.push_back(i);
+				mIndex.emplace(i.value, mCounters.size() - 1);
+				sift_up(mCounters.size() - 1);
+			}
+		}
+
+		/*!
+			\brief Estimate the frequency of a value.
+			\param aValue The value to check.
+			\return An upper bound of the frequency of aValue.
+		*/
+		uint64_t estimate(const T& aValue) const {
+			const auto i = mIndex.find(aValue);
+			if(i != mIndex.end()) return mCounters[i->second].count;
+			return mCounters.size() < mCapacity ? 0 : mCounters[0].count;
+		}
+
+		/*!
+			\brief Get the most frequent values.
+			\param aK The maximum number of values to return.
+			\return Up to aK counters, ordered from most to least frequent.
+		*/
+		std::vector<counter> top(const size_t aK) const {
+			std::vector<counter> tmp = mCounters;
+			const auto compare = [](const counter& a, const counter& b)->bool {
+				return a.count > b.count;
+			};
+			if(aK < tmp.size()) {
+				std::partial_sort(tmp.begin(), tmp.begin() + aK, tmp.end(), compare);
+				tmp.resize(aK);
+			}else {
+				std::sort(tmp.begin(), tmp.end(), compare);
+			}
+			return tmp;
+		}
+
+		/*!
+			\brief Remove all counters.
+		*/
+		void clear() throw() {
+			mCounters.clear();
+			mIndex.clear();
+			mTotal = 0;
+		}
+
+		size_t size() const throw() {
+			return mCounters.size();
+		}
+
+		size_t capacity() const throw() {
+			return mCapacity;
+		}
+
+		uint64_t total() const throw() {
+			return mTotal;
+		}
+	};
+
+	/*!
+		\brief Fixed size frequency sketch using the Count-Min algorithm.
+		\detail With a width of w and depth of d, estimates exceed the true frequency by at most e / w * total()
+		with probability 1 - e^-d. Estimates are never lower than the true frequency. Sketches with the same
+		dimensions can be merged by adding their tables.
+		\tparam T The type of value to count.
+		\tparam HASH The hash function for T.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T, class HASH = std::hash<T>>
+	class count_min_sketch {
+	private:
+		std::vector<uint64_t> mTable;	//!< mDepth rows of mWidth counters
+		size_t mWidth;					//!< Number of counters in each row, always a power of 2
+		size_t mDepth;					//!< Number of rows
+		uint64_t mTotal;				//!< Sum of all counts added
+		HASH mHash;
+
+		size_t index(const uint64_t aHash1, const uint64_t aHash2, const size_t aRow) const throw() {
+			return aRow * mWidth + static_cast<size_t>((aHash1 + aRow * aHash2) & (mWidth - 1));
+		}
+	public:
+		/*!
+			\brief Create a new sketch.
+			\param aWidth The number of counters in each row, rounded up to a power of 2.
+			\param aDepth The number of rows.
+		*/
+		count_min_sketch(size_t aWidth, const size_t aDepth) :
+			mWidth(1),
+			mDepth(aDepth == 0 ? 1 : aDepth),
+			mTotal(0)
+		{
+			while(mWidth < aWidth) mWidth <<= 1;
+			mTable.resize(mWidth * mDepth, 0);
+		}
+
+		/*!
+			\brief Count an instance of a value.
+			\param aValue The value to count.
+			\param aCount The number of instances to add.
+		*/
+		void add(const T& aValue, const uint64_t aCount = 1) {
+			const uint64_t h1 = implementation::mix_hash(static_cast<uint64_t>(mHash(aValue)));
+			const uint64_t h2 = implementation::mix_hash(h1) | 1;
+			for(size_t i = 0; i < mDepth; ++i) mTable[index(h1, h2, i)] += aCount;
+			mTotal += aCount;
+		}
+
+		/*!
+			\brief Estimate the frequency of a value.
+			\param aValue The value to check.
+			\return An upper bound of the frequency of aValue.
+		*/
+		uint64_t estimate(const T& aValue) const {
+			const uint64_t h1 = implementation::mix_hash(static_cast<uint64_t>(mHash(aValue)));
+			const uint64_t h2 = implementation::mix_hash(h1) | 1;
+			uint64_t tmp = mTable[index(h1, h2, 0)];
+			for(size_t i = 1; i < mDepth; ++i) tmp = std::min(tmp, mTable[index(h1, h2, i)]);
+			return tmp;
+		}
+
+		/*!
+			\brief Combine the counts from another sketch into this one.
+			\param aOther The sketch to merge.
+			\return False if the sketches have different dimensions.
+		*/
+		bool merge(const count_min_sketch& aOther) throw() {
+			if(mWidth != aOther.mWidth || mDepth != aOther.mDepth) return false;
+			const size_t size = mTable.size();
+			for(size_t i = 0; i < size; ++i) mTable[i] += aOther.mTable[i];
+			mTotal += aOther.mTotal;
+			return true;
+		}
+
+		/*!
+			\brief Reset all counters to 0.
+		*/
+		void clear() throw() {
+			std::fill(mTable.begin(), mTable.end(), 0);
+			mTotal = 0;
+		}
+
+		size_t width() const throw() {
+			return mWidth;
+		}
+
+		size_t depth() const throw() {
+			return mDepth;
+		}
+
+		uint64_t total() const throw() {
+			return mTotal;
+		}
+	};
+}
+#endif
\ No newline at end of file
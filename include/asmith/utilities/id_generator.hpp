@@ -14,7 +14,9 @@
 #ifndef ASMITH_UTILITIES_ID_GENERATOR_HPP
 #define ASMITH_UTILITIES_ID_GENERATOR_HPP
 
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <vector>
 
 namespace asmith {
@@ -37,6 +39,42 @@ namespace asmith {
 		virtual bool use(T) throw() = 0;
 		virtual bool free(T) throw() = 0;
 		virtual bool is_used(T) const throw() = 0;
+
+		/*!
+			\brief Generate several IDs.
+			\detail The default implementation calls generate once per ID, implementations may override it with a bulk operation.
+			\param aIDs Filled with the generated IDs.
+			\param aCount The number of IDs to generate.
+			\return The number of IDs that were generated.
+		*/
+		virtual size_t generate_n(T* aIDs, size_t aCount) throw() {
+			for(size_t i = 0; i < aCount; ++i) aIDs[i] = generate();
+			return aCount;
+		}
+
+		/*!
+			\brief Mark a range of IDs as used.
+			\param aFirst The first ID in the range.
+			\param aCount The number of IDs in the range.
+			\return False if any ID in the range is already used, in which case none are changed.
+		*/
+		virtual bool use_range(T aFirst, T aCount) throw() {
+			for(T i = 0; i < aCount; ++i) if(is_used(static_cast<T>(aFirst + i))) return false;
+			for(T i = 0; i < aCount; ++i) use(static_cast<T>(aFirst + i));
+			return true;
+		}
+
+		/*!
+			\brief Free a range of IDs.
+			\param aFirst The first ID in the range.
+			\param aCount The number of IDs in the range.
+			\return False if any ID in the range is not used, in which case none are changed.
+		*/
+		virtual bool free_range(T aFirst, T aCount) throw() {
+			for(T i = 0; i < aCount; ++i) if(! is_used(static_cast<T>(aFirst + i))) return false;
+			for(T i = 0; i < aCount; ++i) free(static_cast<T>(aFirst + i));
+			return true;
+		}
 	};
 
 	/*!
@@ -68,6 +106,8 @@ namespace asmith {
 				mFree.pop_back();
 				return id;
 			}else while(true) {
+				// Stop once every value of T has been tried instead of wrapping around forever
+				if(mBase > static_cast<uint64_t>(std::numeric_limits<T>::max())) return static_cast<T>(0);
 				id = static_cast<T>(mBase++);
 				bool free = true;
 				for(const T i : mUsed) if (i == id) {
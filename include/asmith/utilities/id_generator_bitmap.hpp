@@ -0,0 +1,511 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_ID_GENERATOR_BITMAP_HPP
+#define ASMITH_UTILITIES_ID_GENERATOR_BITMAP_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "bit_operations.hpp"
+#include "id_generator.hpp"
+
+namespace asmith {
+
+	/*!
+		\brief An implementation of id_generator that stores one bit per ID.
+		\detail Level 0 of the bitmap has a bit set for each used ID. Each higher level has a bit set for each word of
+		the level below that is full, so the lowest free ID is found by scanning at most one word per level with a
+		trailing zero count. Every operation is O(log64 n) and the bitmap only grows to the highest ID that has been used.
+		\n The state can be saved with serialise and restored with deserialise in O(n / 64), the level 0 words are
+		stored verbatim so a snapshot file can be memory mapped and passed straight to deserialise. Regions of level 0
+		that have changed since the last checkpoint are tracked so that a snapshot file can be updated incrementally
+		with write_dirty.
+		\tparam T The type of ID to manage, must be an unsigned integer.
+		\tparam R True if ID codes can be reused after they have been freed.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T, bool R>
+	class id_generator_bitmap : public id_generator<T> {
+	private:
+		static_assert(std::is_unsigned<T>::value, "asmith::id_generator_bitmap : T must be an unsigned integer");
+
+		enum : uint64_t {
+			WORD_BITS = 64,
+			FULL = ~0ULL,
+			NOT_FOUND = ~0ULL,
+			SERIAL_MAGIC = 0x49444231,	//!< "IDB1"
+			SERIAL_HEADER_SIZE = 32,
+			DIRTY_REGION_WORDS = 64		//!< Number of level 0 words tracked by each dirty bit
+		};
+
+		std::vector<std::vector<uint64_t>> mLevels;	//!< mLevels[0] is the used bits, mLevels[N + 1] is the full bits of mLevels[N]
+		uint64_t mCount;							//!< Number of used IDs
+		uint64_t mNext;								//!< The lowest ID that generate can return when IDs are not reused
+		std::vector<uint64_t> mDirty;				//!< One bit for each region of level 0 that has changed since the last checkpoint
+
+		static inline uint64_t max_id() throw() {
+			return static_cast<uint64_t>(std::numeric_limits<T>::max());
+		}
+
+		static inline uint64_t max_words() throw() {
+			return max_id() / WORD_BITS + 1;
+		}
+
+		static inline void write_64(uint8_t*& aPos, const uint64_t aValue) throw() {
+			for(int i = 0; i < 8; ++i) *(aPos++) = static_cast<uint8_t>(aValue >> (i * 8));
+		}
+
+		static inline uint64_t read_64(const uint8_t*& aPos) throw() {
+			uint64_t tmp = 0;
+			for(int i = 0; i < 8; ++i) tmp |= static_cast<uint64_t>(*(aPos++)) << (i * 8);
+			return tmp;
+		}
+
+		/*!
+			\brief Write level 0 words in little-endian order.
+		*/
+		static void write_words(uint8_t* aPos, const uint64_t* const aWords, const size_t aCount) throw() {
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_MSC_VER)
+			std::memcpy(aPos, aWords, aCount * sizeof(uint64_t));
+#else
+			for(size_t i = 0; i < aCount; ++i) write_64(aPos, aWords[i]);
+#endif
+		}
+
+		static void read_words(const uint8_t* aPos, uint64_t* const aWords, const size_t aCount) throw() {
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_MSC_VER)
+			std::memcpy(aWords, aPos, aCount * sizeof(uint64_t));
+#else
+			for(size_t i = 0; i < aCount; ++i) aWords[i] = read_64(aPos);
+#endif
+		}
+
+		void write_header(uint8_t* aPos) const throw() {
+			for(int i = 0; i < 4; ++i) *(aPos++) = static_cast<uint8_t>(SERIAL_MAGIC >> (i * 8));
+			*(aPos++) = static_cast<uint8_t>(sizeof(T));
+			*(aPos++) = R ? 1 : 0;
+			*(aPos++) = 0;
+			*(aPos++) = 0;
+			write_64(aPos, mCount);
+			write_64(aPos, mNext);
+			write_64(aPos, static_cast<uint64_t>(mLevels[0].size()));
+		}
+
+		inline void mark_dirty(const uint64_t aWord) throw() {
+			const uint64_t region = aWord / DIRTY_REGION_WORDS;
+			mDirty[static_cast<size_t>(region / WORD_BITS)] |= 1ULL << (region % WORD_BITS);
+		}
+
+		/*!
+			\brief Resize the dirty bits after the number of words in level 0 has changed.
+		*/
+		void resize_dirty() {
+			const size_t regions = (mLevels[0].size() + DIRTY_REGION_WORDS - 1) / DIRTY_REGION_WORDS;
+			mDirty.resize((regions + WORD_BITS - 1) / WORD_BITS, 0);
+		}
+
+		/*!
+			\brief Recalculate the summary levels after the number of words in level 0 has changed.
+		*/
+		void rebuild_summary() {
+			mLevels.resize(1);
+			while(mLevels.back().size() > 1) {
+				const std::vector<uint64_t>& below = mLevels.back();
+				std::vector<uint64_t> level((below.size() + WORD_BITS - 1) / WORD_BITS, 0);
+				const size_t size = below.size();
+				for(size_t i = 0; i < size; ++i) if(below[i] == FULL) level[i / WORD_BITS] |= 1ULL << (i % WORD_BITS);
+				mLevels.push_back(std::move(level));
+			}
+		}
+
+		/*!
+			\brief Make sure that the bitmap contains an ID.
+		*/
+		void grow(const uint64_t aID) {
+			const uint64_t words = aID / WORD_BITS + 1;
+			std::vector<uint64_t>& leaves = mLevels[0];
+			if(words <= leaves.size()) return;
+			uint64_t size = leaves.size() * 2;
+			if(size < words) size = words;
+			if(size > max_words()) size = max_words();
+			const size_t old_size = leaves.size();
+			leaves.resize(static_cast<size_t>(size), 0);
+			rebuild_summary();
+			resize_dirty();
+			// The new words extend the snapshot
+			for(uint64_t i = old_size / DIRTY_REGION_WORDS; i <= (size - 1) / DIRTY_REGION_WORDS; ++i) mark_dirty(i * DIRTY_REGION_WORDS);
+		}
+
+		/*!
+			\brief Find the first clear bit at or after a position.
+			\param aLevel The level to search.
+			\param aIndex The position to start at.
+			\return The position, or NOT_FOUND if every bit from aIndex to the end of the level is set.
+		*/
+		uint64_t find_clear(const size_t aLevel, uint64_t aIndex) const throw() {
+			const std::vector<uint64_t>& words = mLevels[aLevel];
+			while(true) {
+				const uint64_t word = aIndex / WORD_BITS;
+				if(word >= words.size()) return NOT_FOUND;
+				const uint64_t bits = ~words[static_cast<size_t>(word)] & (FULL << (aIndex % WORD_BITS));
+				if(bits != 0) return word * WORD_BITS + static_cast<uint64_t>(implementation::count_trailing_zeros(bits));
+
+				// The rest of this word is full, use the level above to skip to the next word with a clear bit
+				if(aLevel + 1 == mLevels.size()) return NOT_FOUND;
+				const uint64_t next = find_clear(aLevel + 1, word + 1);
+				if(next == NOT_FOUND) return NOT_FOUND;
+				aIndex = next * WORD_BITS;
+			}
+		}
+
+		/*!
+			\brief Find the lowest unused ID at or after a position.
+			\return The ID, or a value greater than the maximum ID if all are used.
+		*/
+		uint64_t find_unused(const uint64_t aFrom) const throw() {
+			const uint64_t capacity = static_cast<uint64_t>(mLevels[0].size()) * WORD_BITS;
+			if(aFrom >= capacity) return aFrom;
+			const uint64_t id = find_clear(0, aFrom);
+			return id == NOT_FOUND ? capacity : id;
+		}
+
+		/*!
+			\brief Set a bit and mark the words above it as full if they become full.
+		*/
+		void set_bit(size_t aLevel, uint64_t aIndex) throw() {
+			if(aLevel == 0) mark_dirty(aIndex / WORD_BITS);
+			for(; aLevel < mLevels.size(); ++aLevel) {
+				uint64_t& word = mLevels[aLevel][static_cast<size_t>(aIndex / WORD_BITS)];
+				word |= 1ULL << (aIndex % WORD_BITS);
+				if(word != FULL) break;
+				aIndex /= WORD_BITS;
+			}
+		}
+
+		/*!
+			\brief Clear a bit and mark the words above it as not full if they were full.
+		*/
+		void clear_bit(size_t aLevel, uint64_t aIndex) throw() {
+			if(aLevel == 0) mark_dirty(aIndex / WORD_BITS);
+			for(; aLevel < mLevels.size(); ++aLevel) {
+				uint64_t& word = mLevels[aLevel][static_cast<size_t>(aIndex / WORD_BITS)];
+				const bool was_full = word == FULL;
+				word &= ~(1ULL << (aIndex % WORD_BITS));
+				if(! was_full) break;
+				aIndex /= WORD_BITS;
+			}
+		}
+
+		void set(const uint64_t aID) {
+			grow(aID);
+			set_bit(0, aID);
+			++mCount;
+		}
+
+		void clear(const uint64_t aID) throw() {
+			clear_bit(0, aID);
+			--mCount;
+		}
+
+		/*!
+			\brief Get the mask of the bits of a level 0 word that are in [aFirst, aLast].
+		*/
+		static inline uint64_t range_mask(const uint64_t aWord, const uint64_t aFirst, const uint64_t aLast) throw() {
+			const uint64_t begin = aWord * WORD_BITS;
+			const uint64_t low = aFirst > begin ? aFirst - begin : 0;
+			const uint64_t high = aLast - begin >= WORD_BITS - 1 ? WORD_BITS - 1 : aLast - begin;
+			return (FULL << low) & (FULL >> (WORD_BITS - 1 - high));
+		}
+
+		/*!
+			\brief Check if any ID in [aFirst, aLast] is used.
+		*/
+		bool any_used(const uint64_t aFirst, const uint64_t aLast) const throw() {
+			const std::vector<uint64_t>& leaves = mLevels[0];
+			const uint64_t last_word = aLast / WORD_BITS;
+			for(uint64_t i = aFirst / WORD_BITS; i <= last_word && i < leaves.size(); ++i) {
+				if((leaves[static_cast<size_t>(i)] & range_mask(i, aFirst, aLast)) != 0) return true;
+			}
+			return false;
+		}
+
+		/*!
+			\brief Check if every ID in [aFirst, aLast] is used.
+		*/
+		bool all_used(const uint64_t aFirst, const uint64_t aLast) const throw() {
+			const std::vector<uint64_t>& leaves = mLevels[0];
+			const uint64_t last_word = aLast / WORD_BITS;
+			if(last_word >= leaves.size()) return false;
+			for(uint64_t i = aFirst / WORD_BITS; i <= last_word; ++i) {
+				const uint64_t mask = range_mask(i, aFirst, aLast);
+				if((leaves[static_cast<size_t>(i)] & mask) != mask) return false;
+			}
+			return true;
+		}
+	public:
+		/*!
+			\brief Create a new generator.
+			\param aReserve The number of IDs to allocate memory for.
+		*/
+		id_generator_bitmap(const uint64_t aReserve = 0) :
+			mLevels(1, std::vector<uint64_t>(1, 0)),
+			mCount(0),
+			mNext(0),
+			mDirty(1, 1)
+		{
+			if(aReserve > 0) grow(aReserve - 1);
+		}
+
+		/*!
+			\brief Get an unused ID and mark it as used.
+			\param aID Set to the ID.
+			\return False if every ID is in use (or has been used when IDs are not reused).
+		*/
+		bool try_generate(T& aID) {
+			const uint64_t id = find_unused(R ? 0 : mNext);
+			if(id > max_id() || (! R && mNext > max_id())) return false;
+			set(id);
+			if(! R) mNext = id + 1;
+			aID = static_cast<T>(id);
+			return true;
+		}
+
+		/*!
+			\brief Check if generate can return another ID.
+		*/
+		bool exhausted() const throw() {
+			return find_unused(R ? 0 : mNext) > max_id() || (! R && mNext > max_id());
+		}
+
+		/*!
+			\brief Get the number of used IDs.
+		*/
+		uint64_t size() const throw() {
+			return mCount;
+		}
+
+		/*!
+			\brief Get the number of IDs that the bitmap currently has memory for.
+		*/
+		uint64_t capacity() const throw() {
+			return static_cast<uint64_t>(mLevels[0].size()) * WORD_BITS;
+		}
+
+		/*!
+			\brief Free every ID and release the memory.
+		*/
+		void reset() {
+			mLevels.assign(1, std::vector<uint64_t>(1, 0));
+			mCount = 0;
+			mNext = 0;
+			mDirty.assign(1, 1);
+		}
+
+		/*!
+			\brief Calculate the size of the serialised state.
+			\return The number of bytes that serialise will write.
+		*/
+		size_t serialised_size() const throw() {
+			return SERIAL_HEADER_SIZE + mLevels[0].size() * sizeof(uint64_t);
+		}
+
+		/*!
+			\brief Write the state of the generator to a buffer.
+			\detail All fields are little-endian. Layout : magic (4 bytes), sizeof(T) (1 byte), R (1 byte), 2 bytes of
+			padding, used ID count, next ID and word count (8 bytes each), then the level 0 words (8 bytes each).
+			The words start 32 bytes into the buffer so they are aligned if the buffer is. Clears the dirty regions.
+			\param aBuffer The buffer to write to, must be at least serialised_size() bytes.
+			\return The number of bytes written.
+		*/
+		size_t serialise(uint8_t* const aBuffer) throw() {
+			write_header(aBuffer);
+			write_words(aBuffer + SERIAL_HEADER_SIZE, mLevels[0].data(), mLevels[0].size());
+			std::fill(mDirty.begin(), mDirty.end(), 0);
+			return serialised_size();
+		}
+
+		/*!
+			\brief Write the state of the generator to a new buffer.
+			\return The serialised state.
+			\see serialise(uint8_t*)
+		*/
+		std::vector<uint8_t> serialise() {
+			std::vector<uint8_t> tmp(serialised_size());
+			serialise(tmp.data());
+			return tmp;
+		}
+
+		/*!
+			\brief Replace the state of the generator with a serialised state.
+			\detail O(n / 64), no per-ID work is done. The buffer is copied so it can be unmapped afterwards.
+			\param aBuffer The serialised data, for example a memory mapped snapshot file.
+			\param aSize The size of aBuffer in bytes.
+			\return False if aBuffer does not contain a valid state for this type of generator, in which case this generator is not modified.
+		*/
+		bool deserialise(const uint8_t* const aBuffer, const size_t aSize) {
+			if(aSize < SERIAL_HEADER_SIZE) return false;
+			const uint8_t* pos = aBuffer;
+			uint32_t magic = 0;
+			for(int i = 0; i < 4; ++i) magic |= static_cast<uint32_t>(*(pos++)) << (i * 8);
+			if(magic != SERIAL_MAGIC) return false;
+			if(*(pos++) != sizeof(T)) return false;
+			if(*(pos++) != (R ? 1 : 0)) return false;
+			pos += 2;
+			const uint64_t count = read_64(pos);
+			const uint64_t next = read_64(pos);
+			const uint64_t words = read_64(pos);
+			if(words == 0 || words > max_words() || words > (aSize - SERIAL_HEADER_SIZE) / sizeof(uint64_t)) return false;
+
+			std::vector<uint64_t> leaves(static_cast<size_t>(words));
+			read_words(pos, leaves.data(), leaves.size());
+			uint64_t used = 0;
+			for(const uint64_t i : leaves) used += static_cast<uint64_t>(implementation::population_count(i));
+			if(used != count) return false;
+
+			mLevels.assign(1, std::move(leaves));
+			rebuild_summary();
+			mCount = count;
+			mNext = next;
+			mDirty.clear();
+			resize_dirty();
+			return true;
+		}
+
+		/*!
+			\brief Write the parts of the state that have changed since the last checkpoint.
+			\detail The header is always written, followed by each dirty region of level 0 words. Applying the writes
+			to a copy of the last full snapshot (extending it if needed) makes it identical to the output of serialise.
+			Clears the dirty regions.
+			\param aWrite Called with the byte offset in the snapshot, a pointer to the data and its size in bytes.
+			The data is only valid for the duration of the call.
+			\return The number of bytes written.
+		*/
+		template<class F>
+		size_t write_dirty(F&& aWrite) {
+			uint8_t buffer[DIRTY_REGION_WORDS * sizeof(uint64_t)];
+			write_header(buffer);
+			aWrite(static_cast<size_t>(0), static_cast<const uint8_t*>(buffer), static_cast<size_t>(SERIAL_HEADER_SIZE));
+			size_t bytes = SERIAL_HEADER_SIZE;
+
+			const std::vector<uint64_t>& leaves = mLevels[0];
+			const size_t size = mDirty.size();
+			for(size_t i = 0; i < size; ++i) {
+				uint64_t bits = mDirty[i];
+				mDirty[i] = 0;
+				while(bits != 0) {
+					const size_t region = i * WORD_BITS + static_cast<size_t>(implementation::count_trailing_zeros(bits));
+					bits &= bits - 1;
+					const size_t first = region * DIRTY_REGION_WORDS;
+					const size_t count = std::min<size_t>(DIRTY_REGION_WORDS, leaves.size() - first);
+					write_words(buffer, leaves.data() + first, count);
+					aWrite(SERIAL_HEADER_SIZE + first * sizeof(uint64_t), static_cast<const uint8_t*>(buffer), count * sizeof(uint64_t));
+					bytes += count * sizeof(uint64_t);
+				}
+			}
+			return bytes;
+		}
+
+		/*!
+			\brief Get the number of level 0 words that write_dirty would write.
+		*/
+		size_t dirty_words() const throw() {
+			size_t tmp = 0;
+			for(const uint64_t i : mDirty) tmp += static_cast<size_t>(implementation::population_count(i));
+			return tmp * DIRTY_REGION_WORDS;
+		}
+
+		// Inherited from id_generator
+
+		/*!
+			\return The ID, or 0 if every ID is in use.
+			\see try_generate
+		*/
+		T generate() throw() override {
+			T id = static_cast<T>(0);
+			try_generate(id);
+			return id;
+		}
+
+		bool use(T aID) throw() override {
+			if(is_used(aID)) return false;
+			set(static_cast<uint64_t>(aID));
+			return true;
+		}
+
+		bool free(T aID) throw() override {
+			if(! is_used(aID)) return false;
+			clear(static_cast<uint64_t>(aID));
+			return true;
+		}
+
+		/*!
+			\detail Sets or clears a whole word of bits at a time.
+		*/
+		bool use_range(T aFirst, T aCount) throw() override {
+			if(aCount == 0) return true;
+			const uint64_t first = static_cast<uint64_t>(aFirst);
+			const uint64_t last = first + static_cast<uint64_t>(aCount) - 1;
+			if(last > max_id() || last < first || any_used(first, last)) return false;
+			grow(last);
+			std::vector<uint64_t>& leaves = mLevels[0];
+			for(uint64_t i = first / WORD_BITS; i <= last / WORD_BITS; ++i) {
+				uint64_t& word = leaves[static_cast<size_t>(i)];
+				word |= range_mask(i, first, last);
+				mark_dirty(i);
+				if(word == FULL) set_bit(1, i);
+			}
+			mCount += last - first + 1;
+			return true;
+		}
+
+		/*!
+			\detail Sets or clears a whole word of bits at a time.
+		*/
+		bool free_range(T aFirst, T aCount) throw() override {
+			if(aCount == 0) return true;
+			const uint64_t first = static_cast<uint64_t>(aFirst);
+			const uint64_t last = first + static_cast<uint64_t>(aCount) - 1;
+			if(last > max_id() || last < first || ! all_used(first, last)) return false;
+			std::vector<uint64_t>& leaves = mLevels[0];
+			for(uint64_t i = first / WORD_BITS; i <= last / WORD_BITS; ++i) {
+				uint64_t& word = leaves[static_cast<size_t>(i)];
+				const bool was_full = word == FULL;
+				word &= ~range_mask(i, first, last);
+				mark_dirty(i);
+				if(was_full) clear_bit(1, i);
+			}
+			mCount -= last - first + 1;
+			return true;
+		}
+
+		size_t generate_n(T* aIDs, size_t aCount) throw() override {
+			for(size_t i = 0; i < aCount; ++i) if(! try_generate(aIDs[i])) return i;
+			return aCount;
+		}
+
+		bool is_used(T aID) const throw() override {
+			const uint64_t id = static_cast<uint64_t>(aID);
+			const uint64_t word = id / WORD_BITS;
+			const std::vector<uint64_t>& leaves = mLevels[0];
+			return word < leaves.size() && (leaves[static_cast<size_t>(word)] & (1ULL << (id % WORD_BITS))) != 0;
+		}
+	};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,326 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_ID_GENERATOR_CONCURRENT_HPP
+#define ASMITH_UTILITIES_ID_GENERATOR_CONCURRENT_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include "bit_operations.hpp"
+#include "id_generator.hpp"
+#include "thread_index.hpp"
+
+namespace asmith {
+
+	/*!
+		\brief A thread safe, lock-free implementation of id_generator with a fixed capacity.
+		\detail The global pool is two arrays of atomic bitmap words. A used bit is set while an ID is owned, a reserved
+		bit is set while an ID is used or sitting in a cache. Each thread is assigned one of SHARDS caches of reserved IDs,
+		generate pops from the cache and refills it by claiming all free bits of a bitmap word with a single compare and
+		swap, free pushes onto the cache and returns half of it to the global pool when it is full. A cache is protected
+		by a try-lock, if it is busy (because more threads than shards are active) the thread uses the global pool
+		directly instead of waiting. When the global pool is empty generate takes IDs from other threads' caches, so
+		IDs cached by threads that have exited are not lost.
+		\n The used bit is authoritative, an ID taken from a cache or the pool is only returned if setting its used bit
+		succeeds, so IDs passed to use while they are cached are skipped.
+		\n IDs are not returned in ascending order. When R is false freed IDs keep their reserved bit and also set a
+		retired bit, which generate checks before returning an ID taken from a cache, so an ID that was passed to use and
+		freed while a copy of it was cached is never generated again.
+		\tparam T The type of ID to manage, must be an unsigned integer.
+		\tparam R True if ID codes can be reused after they have been freed.
+		\tparam SHARDS The number of caches.
+		\tparam CACHE_SIZE The maximum number of IDs held by each cache.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T, bool R, size_t SHARDS = 16, size_t CACHE_SIZE = 64>
+	class id_generator_concurrent : public id_generator<T> {
+	private:
+		static_assert(std::is_unsigned<T>::value, "asmith::id_generator_concurrent : T must be an unsigned integer");
+		static_assert(SHARDS > 0 && CACHE_SIZE >= 2, "asmith::id_generator_concurrent : Invalid cache configuration");
+
+		enum : uint64_t {
+			WORD_BITS = 64,
+			FULL = ~0ULL
+		};
+
+		struct shard {
+			std::atomic<bool> locked;
+			uint32_t count;				//!< Number of cached IDs, only accessed while locked
+			T ids[CACHE_SIZE];			//!< Cached IDs, the next one to be generated is at the back
+			uint8_t padding[64];		//!< Keeps neighbouring shards' locks off this cache line
+		};
+
+		std::unique_ptr<std::atomic<uint64_t>[]> mUsed;
+		std::unique_ptr<std::atomic<uint64_t>[]> mReserved;
+		std::unique_ptr<std::atomic<uint64_t>[]> mRetired;	//!< IDs that have been freed, only allocated when R is false
+		const uint64_t mCapacity;
+		const size_t mWords;
+		std::atomic<size_t> mCursor;	//!< The word that the last successful claim was made from
+		std::unique_ptr<shard[]> mShards;
+
+		id_generator_concurrent(const id_generator_concurrent&) = delete;
+		id_generator_concurrent& operator=(const id_generator_concurrent&) = delete;
+
+		static uint64_t default_capacity() throw() {
+			const uint64_t max = static_cast<uint64_t>(std::numeric_limits<T>::max());
+			return max < (1ULL << 22) ? max + 1 : 1ULL << 22;
+		}
+
+		static inline bool try_lock(shard& aShard) throw() {
+			return ! aShard.locked.load(std::memory_order_relaxed) && ! aShard.locked.exchange(true, std::memory_order_acquire);
+		}
+
+		static inline void unlock(shard& aShard) throw() {
+			aShard.locked.store(false, std::memory_order_release);
+		}
+
+		inline shard& get_shard() throw() {
+			return mShards[implementation::thread_index() % SHARDS];
+		}
+
+		/*!
+			\brief Set the used bit of an ID.
+			\return False if it was already set.
+		*/
+		inline bool mark_used(const uint64_t aID) throw() {
+			const uint64_t bit = 1ULL << (aID % WORD_BITS);
+			return (mUsed[aID / WORD_BITS].fetch_or(bit, std::memory_order_acq_rel) & bit) == 0;
+		}
+
+		/*!
+			\brief Set the used bit of an ID that is about to be generated.
+			\return False if it was already set or the ID has been retired.
+		*/
+		inline bool mark_generated(const uint64_t aID) throw() {
+			if(! mark_used(aID)) return false;
+			if(R) return true;
+			// The used bit was clear, so free has already set the retired bit of an ID that was freed
+			const uint64_t bit = 1ULL << (aID % WORD_BITS);
+			if((mRetired[aID / WORD_BITS].load(std::memory_order_acquire) & bit) == 0) return true;
+			mUsed[aID / WORD_BITS].fetch_and(~bit, std::memory_order_release);
+			return false;
+		}
+
+		inline void release(const uint64_t aID) throw() {
+			mReserved[aID / WORD_BITS].fetch_and(~(1ULL << (aID % WORD_BITS)), std::memory_order_release);
+		}
+
+		/*!
+			\brief Claim up to aCount free IDs from one word of the global pool.
+			\param aIDs Filled with the claimed IDs, the lowest is written last.
+			\return The number of IDs claimed.
+		*/
+		size_t claim(const size_t aWord, const size_t aCount, T* const aIDs) throw() {
+			std::atomic<uint64_t>& word = mReserved[aWord];
+			uint64_t old = word.load(std::memory_order_relaxed);
+			while(old != FULL) {
+				uint64_t take = 0;
+				uint64_t free = ~old;
+				for(size_t i = 0; i < aCount && free != 0; ++i) {
+					const uint64_t lowest = free & (~free + 1);
+					take |= lowest;
+					free ^= lowest;
+				}
+				if(word.compare_exchange_weak(old, old | take, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+					size_t count = static_cast<size_t>(implementation::population_count(take));
+					const uint64_t base = static_cast<uint64_t>(aWord) * WORD_BITS;
+					for(size_t i = count; i > 0; --i) {
+						aIDs[i - 1] = static_cast<T>(base + static_cast<uint64_t>(implementation::count_trailing_zeros(take)));
+						take &= take - 1;
+					}
+					return count;
+				}
+			}
+			return 0;
+		}
+
+		/*!
+			\brief Claim up to aCount free IDs from the global pool, starting at the word that was last claimed from.
+			\return The number of IDs claimed, 0 if the pool is empty.
+		*/
+		size_t reserve(const size_t aCount, T* const aIDs) throw() {
+			const size_t start = mCursor.load(std::memory_order_relaxed);
+			for(size_t i = 0; i < mWords; ++i) {
+				size_t word = start + i;
+				if(word >= mWords) word -= mWords;
+				const size_t count = claim(word, aCount, aIDs);
+				if(count > 0) {
+					if(word != start) mCursor.store(word, std::memory_order_relaxed);
+					return count;
+				}
+			}
+			return 0;
+		}
+	public:
+		/*!
+			\brief Create a new generator.
+			\param aCapacity The number of IDs that can be generated, IDs are in the range [0, aCapacity).
+			Defaults to the full range of T, up to 2^22.
+		*/
+		id_generator_concurrent(const uint64_t aCapacity = default_capacity()) :
+			mCapacity(aCapacity),
+			mWords(static_cast<size_t>((aCapacity + WORD_BITS - 1) / WORD_BITS)),
+			mCursor(0)
+		{
+			mUsed.reset(new std::atomic<uint64_t>[mWords == 0 ? 1 : mWords]);
+			mReserved.reset(new std::atomic<uint64_t>[mWords == 0 ? 1 : mWords]);
+			if(! R) mRetired.reset(new std::atomic<uint64_t>[mWords == 0 ? 1 : mWords]);
+			for(size_t i = 0; i < mWords; ++i) {
+				mUsed[i].store(0, std::memory_order_relaxed);
+				mReserved[i].store(0, std::memory_order_relaxed);
+				if(! R) mRetired[i].store(0, std::memory_order_relaxed);
+			}
+			// IDs past the capacity in the last word are permanently reserved
+			if(aCapacity % WORD_BITS != 0) mReserved[mWords - 1].store(FULL << (aCapacity % WORD_BITS), std::memory_order_relaxed);
+
+			mShards.reset(new shard[SHARDS]);
+			for(size_t i = 0; i < SHARDS; ++i) {
+				mShards[i].locked.store(false, std::memory_order_relaxed);
+				mShards[i].count = 0;
+			}
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+
+		/*!
+			\brief Get an unused ID and mark it as used.
+			\param aID Set to the ID.
+			\return False if every ID is in use.
+		*/
+		bool try_generate(T& aID) throw() {
+			shard& s = get_shard();
+			if(try_lock(s)) {
+				while(true) {
+					if(s.count == 0) {
+						s.count = static_cast<uint32_t>(reserve(CACHE_SIZE / 2, s.ids));
+						if(s.count == 0) break;
+					}
+					const T id = s.ids[--s.count];
+					if(mark_generated(id)) {
+						unlock(s);
+						aID = id;
+						return true;
+					}
+				}
+				unlock(s);
+			}
+
+			// The cache is busy or empty, take IDs from the global pool one at a time
+			T id;
+			while(reserve(1, &id) == 1) {
+				if(mark_generated(id)) {
+					aID = id;
+					return true;
+				}
+			}
+
+			// The pool is empty, take an ID from another thread's cache (the thread may have exited)
+			for(size_t i = 0; i < SHARDS; ++i) {
+				shard& other = mShards[i];
+				if(&other == &s) continue;
+				while(! try_lock(other)) std::this_thread::yield();
+				while(other.count > 0) {
+					id = other.ids[--other.count];
+					if(mark_generated(id)) {
+						unlock(other);
+						aID = id;
+						return true;
+					}
+				}
+				unlock(other);
+			}
+			return false;
+		}
+
+		/*!
+			\brief Get the number of IDs that can be managed.
+		*/
+		uint64_t capacity() const throw() {
+			return mCapacity;
+		}
+
+		/*!
+			\brief Count the used IDs.
+			\detail O(capacity / 64), the result is a snapshot if other threads are modifying the generator.
+		*/
+		uint64_t size() const throw() {
+			uint64_t tmp = 0;
+			for(size_t i = 0; i < mWords; ++i) tmp += static_cast<uint64_t>(implementation::population_count(mUsed[i].load(std::memory_order_relaxed)));
+			return tmp;
+		}
+
+		// Inherited from id_generator
+
+		/*!
+			\return The ID, or 0 if every ID is in use.
+			\see try_generate
+		*/
+		T generate() throw() override {
+			T id = static_cast<T>(0);
+			try_generate(id);
+			return id;
+		}
+
+		bool use(T aID) throw() override {
+			const uint64_t id = static_cast<uint64_t>(aID);
+			if(id >= mCapacity || ! mark_used(id)) return false;
+			mReserved[id / WORD_BITS].fetch_or(1ULL << (id % WORD_BITS), std::memory_order_acq_rel);
+			return true;
+		}
+
+		bool free(T aID) throw() override {
+			const uint64_t id = static_cast<uint64_t>(aID);
+			if(id >= mCapacity) return false;
+			const uint64_t bit = 1ULL << (id % WORD_BITS);
+			if(! R) {
+				if((mUsed[id / WORD_BITS].load(std::memory_order_acquire) & bit) == 0) return false;
+				// Retire before clearing the used bit so that a cached copy can not be generated once the bit is clear
+				mRetired[id / WORD_BITS].fetch_or(bit, std::memory_order_acq_rel);
+				return (mUsed[id / WORD_BITS].fetch_and(~bit, std::memory_order_acq_rel) & bit) != 0;
+			}
+			if((mUsed[id / WORD_BITS].fetch_and(~bit, std::memory_order_acq_rel) & bit) == 0) return false;
+
+			shard& s = get_shard();
+			if(try_lock(s)) {
+				if(s.count == CACHE_SIZE) {
+					// Return the oldest half of the cache to the global pool
+					const uint32_t half = static_cast<uint32_t>(CACHE_SIZE / 2);
+					for(uint32_t i = 0; i < half; ++i) release(s.ids[i]);
+					for(uint32_t i = half; i < s.count; ++i) s.ids[i - half] = s.ids[i];
+					s.count -= half;
+				}
+				s.ids[s.count++] = aID;
+				unlock(s);
+			}else {
+				release(id);
+			}
+			return true;
+		}
+
+		size_t generate_n(T* aIDs, size_t aCount) throw() override {
+			for(size_t i = 0; i < aCount; ++i) if(! try_generate(aIDs[i])) return i;
+			return aCount;
+		}
+
+		bool is_used(T aID) const throw() override {
+			const uint64_t id = static_cast<uint64_t>(aID);
+			return id < mCapacity && (mUsed[id / WORD_BITS].load(std::memory_order_acquire) & (1ULL << (id % WORD_BITS))) != 0;
+		}
+	};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,253 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_ID_GENERATOR_DEFERRED_HPP
+#define ASMITH_UTILITIES_ID_GENERATOR_DEFERRED_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+#include "thread_index.hpp"
+#include "id_generator.hpp"
+
+namespace asmith {
+
+	namespace implementation {
+		enum : size_t {
+			ID_GENERATOR_DEFERRED_PADDING = 128	//!< Stride between reader slots, so that no two slots share a cache line regardless of alignment
+		};
+	}
+
+	/*!
+		\brief Wraps an id_generator so that freed IDs are not reused until every reader that could still hold them has finished.
+		\detail Uses epoch based reclamation. Readers call enter before looking up an ID and exit afterwards, which
+		announces the global epoch in the calling thread's cache line padded slot. A freed ID is retired with the current
+		epoch and only returned to the wrapped generator once the epoch has advanced twice, which can only happen after
+		every reader that entered before the free has exited. Readers never take a lock, they only increment and decrement
+		a counter in their own slot.
+		\n The quarantine depth optionally keeps the last N freed IDs out of circulation even after their grace period,
+		which gives FIFO reuse for generators where readers do not announce themselves.
+		\n generate, use, free and is_used lock a mutex, so the wrapped generator does not need to be thread safe.
+		Retired IDs are still reported as used by is_used.
+		\tparam T The type of ID to manage.
+		\tparam SLOTS The number of reader slots, threads beyond this share slots.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T, size_t SLOTS = 64>
+	class id_generator_deferred : public id_generator<T> {
+	public:
+		/*!
+			\brief Returned by enter and passed back to exit.
+		*/
+		struct read_token {
+			uint64_t epoch;		//!< The epoch announced by the reader
+			uint32_t slot;		//!< The slot of the thread that entered
+		};
+
+		/*!
+			\brief Calls enter on construction and exit on destruction.
+		*/
+		class read_guard {
+		private:
+			id_generator_deferred& mGenerator;
+			read_token mToken;
+
+			read_guard(const read_guard&) = delete;
+			read_guard& operator=(const read_guard&) = delete;
+		public:
+			read_guard(id_generator_deferred& aGenerator) throw() :
+				mGenerator(aGenerator),
+				mToken(aGenerator.enter())
+			{}
+
+			~read_guard() throw() {
+				mGenerator.exit(mToken);
+			}
+		};
+	private:
+		enum : uint64_t {
+			BUCKETS = 3		//!< Readers can only be in the current epoch or the one before it, a third bucket lets the oldest drain
+		};
+
+		struct slot {
+			std::atomic<uint32_t> readers[BUCKETS];	//!< Number of readers in the slot that announced each epoch modulo BUCKETS
+			uint8_t padding[implementation::ID_GENERATOR_DEFERRED_PADDING - sizeof(std::atomic<uint32_t>) * BUCKETS];
+		};
+
+		struct retired {
+			T id;				//!< The freed ID
+			uint64_t epoch;		//!< The epoch when it was freed
+		};
+
+		slot mSlots[SLOTS];
+		std::atomic<uint64_t> mEpoch;
+		mutable std::mutex mLock;
+		std::deque<retired> mRetired;			//!< Freed IDs in the order they were freed
+		std::unordered_set<T> mRetiredIDs;		//!< Freed IDs for detecting double frees
+		id_generator<T>& mGenerator;
+		const size_t mQuarantine;
+
+		id_generator_deferred(const id_generator_deferred&) = delete;
+		id_generator_deferred& operator=(const id_generator_deferred&) = delete;
+
+		/*!
+			\brief Return IDs whose grace period has passed to the wrapped generator.
+			\detail mLock must be held.
+		*/
+		size_t release_locked() throw() {
+			const uint64_t epoch = mEpoch.load(std::memory_order_seq_cst);
+			size_t count = 0;
+			while(mRetired.size() > mQuarantine && mRetired.front().epoch + 2 <= epoch) {
+				const T id = mRetired.front().id;
+				mRetired.pop_front();
+				mRetiredIDs.erase(id);
+				mGenerator.free(id);
+				++count;
+			}
+			return count;
+		}
+	public:
+		/*!
+			\brief Create a new wrapper.
+			\param aGenerator The generator to wrap, it must outlive the wrapper and should not be used directly while wrapped.
+			\param aQuarantine The minimum number of more recently freed IDs that must exist before an ID is reused.
+		*/
+		id_generator_deferred(id_generator<T>& aGenerator, const size_t aQuarantine = 0) :
+			mEpoch(BUCKETS),
+			mGenerator(aGenerator),
+			mQuarantine(aQuarantine)
+		{
+			for(slot& s : mSlots) for(std::atomic<uint32_t>& r : s.readers) r.store(0, std::memory_order_relaxed);
+		}
+
+		/*!
+			\brief Return every retired ID to the wrapped generator.
+			\detail No reader may be active.
+		*/
+		~id_generator_deferred() throw() {
+			for(const retired& r : mRetired) mGenerator.free(r.id);
+		}
+
+		/*!
+			\brief Announce that the calling thread is about to look up IDs.
+			\detail IDs freed after this call will not be reused until the matching call to exit.
+			\return The token that must be passed to exit.
+		*/
+		inline read_token enter() throw() {
+			read_token tmp;
+			tmp.slot = implementation::thread_index() % SLOTS;
+			slot& s = mSlots[tmp.slot];
+			while(true) {
+				tmp.epoch = mEpoch.load(std::memory_order_seq_cst);
+				std::atomic<uint32_t>& readers = s.readers[tmp.epoch % BUCKETS];
+				readers.fetch_add(1, std::memory_order_seq_cst);
+				// If the epoch moved before the announcement was visible the bucket may already have been checked
+				if(mEpoch.load(std::memory_order_seq_cst) == tmp.epoch) return tmp;
+				readers.fetch_sub(1, std::memory_order_release);
+			}
+		}
+
+		/*!
+			\brief Report that the calling thread no longer holds any IDs it looked up since the matching enter.
+			\param aToken The value returned by the matching call to enter.
+		*/
+		inline void exit(const read_token aToken) throw() {
+			mSlots[aToken.slot].readers[aToken.epoch % BUCKETS].fetch_sub(1, std::memory_order_release);
+		}
+
+		/*!
+			\brief Report a quiescent state for a long running reader without leaving the read side.
+			\detail Equivalent to exit followed by enter, allows the epoch to advance past the reader.
+			\param aToken The token returned by enter, it is replaced with the new token.
+		*/
+		inline void quiescent(read_token& aToken) throw() {
+			if(mEpoch.load(std::memory_order_relaxed) == aToken.epoch) return;
+			exit(aToken);
+			aToken = enter();
+		}
+
+		/*!
+			\brief Advance the global epoch if no reader is still announcing the previous one.
+			\return True if the epoch was advanced.
+		*/
+		bool try_advance() throw() {
+			uint64_t epoch = mEpoch.load(std::memory_order_seq_cst);
+			const uint64_t previous = (epoch - 1) % BUCKETS;
+			for(const slot& s : mSlots) if(s.readers[previous].load(std::memory_order_seq_cst) != 0) return false;
+			return mEpoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+		}
+
+		/*!
+			\brief Advance the epoch and return IDs whose grace period has passed to the wrapped generator.
+			\detail Called automatically by generate.
+			\return The number of IDs that became available for reuse.
+		*/
+		size_t reclaim() throw() {
+			try_advance();
+			std::lock_guard<std::mutex> lock(mLock);
+			return release_locked();
+		}
+
+		/*!
+			\brief Get the number of freed IDs that are waiting for their grace period.
+		*/
+		size_t get_retired_count() throw() {
+			std::lock_guard<std::mutex> lock(mLock);
+			return mRetired.size();
+		}
+
+		/*!
+			\brief Get the current global epoch.
+		*/
+		uint64_t get_epoch() const throw() {
+			return mEpoch.load(std::memory_order_acquire);
+		}
+
+		// Inherited from id_generator
+
+		T generate() throw() override {
+			std::lock_guard<std::mutex> lock(mLock);
+			if(! mRetired.empty()) {
+				try_advance();
+				release_locked();
+			}
+			return mGenerator.generate();
+		}
+
+		bool use(T aID) throw() override {
+			std::lock_guard<std::mutex> lock(mLock);
+			return mGenerator.use(aID);
+		}
+
+		bool free(T aID) throw() override {
+			std::lock_guard<std::mutex> lock(mLock);
+			if(! mGenerator.is_used(aID)) return false;
+			if(! mRetiredIDs.insert(aID).second) return false;
+			retired tmp;
+			tmp.id = aID;
+			tmp.epoch = mEpoch.load(std::memory_order_seq_cst);
+			mRetired.push_back(tmp);
+			return true;
+		}
+
+		bool is_used(T aID) const throw() override {
+			std::lock_guard<std::mutex> lock(mLock);
+			return mGenerator.is_used(aID);
+		}
+	};
+}
+#endif
\ No newline at end of file
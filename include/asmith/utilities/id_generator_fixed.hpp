@@ -0,0 +1,184 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_ID_GENERATOR_FIXED_HPP
+#define ASMITH_UTILITIES_ID_GENERATOR_FIXED_HPP
+
+#include <cstdint>
+#include <array>
+#include <limits>
+#include <type_traits>
+#include "bit_operations.hpp"
+#include "id_generator.hpp"
+
+namespace asmith {
+
+	/*!
+		\brief An implementation of id_generator for small ID types that does not use the heap.
+		\detail The capacity is every value of T, stored as an inline bitset with one bit per ID and a summary with one
+		bit per full word. The lowest free ID is found by scanning at most one bitset word and the summary words
+		(1 for uint8_t, 16 for uint16_t), so uint8_t generators fit in one cache line and uint16_t ones in about 8KB.
+		The constructor is constexpr, so a generator with static storage duration is constant initialised.
+		\tparam T The type of ID to manage, an unsigned integer of at most 16 bits.
+		\tparam R True if ID codes can be reused after they have been freed.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T, bool R>
+	class id_generator_fixed : public id_generator<T> {
+	private:
+		static_assert(std::is_unsigned<T>::value && sizeof(T) <= 2, "asmith::id_generator_fixed : T must be an unsigned integer of at most 16 bits");
+
+		enum : uint32_t {
+			CAPACITY = static_cast<uint32_t>(std::numeric_limits<T>::max()) + 1,
+			WORD_BITS = 64,
+			WORDS = (CAPACITY + WORD_BITS - 1) / WORD_BITS,
+			SUMMARY_WORDS = (WORDS + WORD_BITS - 1) / WORD_BITS
+		};
+
+		enum : uint64_t {
+			FULL = ~0ULL
+		};
+
+		std::array<uint64_t, WORDS> mUsed;				//!< A bit is set for each used ID
+		std::array<uint64_t, SUMMARY_WORDS> mFull;		//!< A bit is set for each full word of mUsed
+		uint32_t mCount;								//!< Number of used IDs
+		uint32_t mNext;									//!< The lowest ID that generate can return when IDs are not reused
+
+		/*!
+			\brief Find the lowest unused ID at or after a position.
+			\return The ID, or CAPACITY if all are used.
+		*/
+		uint32_t find_unused(const uint32_t aFrom) const throw() {
+			if(aFrom >= CAPACITY) return CAPACITY;
+			const uint32_t word = aFrom / WORD_BITS;
+			const uint64_t bits = ~mUsed[word] & (FULL << (aFrom % WORD_BITS));
+			if(bits != 0) return word * WORD_BITS + static_cast<uint32_t>(implementation::count_trailing_zeros(bits));
+
+			// Use the summary to find the next word that is not full
+			const uint32_t next = word + 1;
+			for(uint32_t i = next / WORD_BITS; i < SUMMARY_WORDS; ++i) {
+				uint64_t candidates = ~mFull[i];
+				if(i == next / WORD_BITS) candidates &= FULL << (next % WORD_BITS);
+				if(candidates != 0) {
+					const uint32_t w = i * WORD_BITS + static_cast<uint32_t>(implementation::count_trailing_zeros(candidates));
+					if(w >= WORDS) return CAPACITY;
+					return w * WORD_BITS + static_cast<uint32_t>(implementation::count_trailing_zeros(~mUsed[w]));
+				}
+			}
+			return CAPACITY;
+		}
+
+		void set(const uint32_t aID) throw() {
+			const uint32_t word = aID / WORD_BITS;
+			mUsed[word] |= 1ULL << (aID % WORD_BITS);
+			if(mUsed[word] == FULL) mFull[word / WORD_BITS] |= 1ULL << (word % WORD_BITS);
+			++mCount;
+		}
+
+		void clear(const uint32_t aID) throw() {
+			const uint32_t word = aID / WORD_BITS;
+			mUsed[word] &= ~(1ULL << (aID % WORD_BITS));
+			mFull[word / WORD_BITS] &= ~(1ULL << (word % WORD_BITS));
+			--mCount;
+		}
+	public:
+		constexpr id_generator_fixed() throw() :
+			mUsed(),
+			mFull(),
+			mCount(0),
+			mNext(0)
+		{}
+
+		/*!
+			\brief Get the number of IDs that can be managed.
+		*/
+		static constexpr uint32_t capacity() throw() {
+			return CAPACITY;
+		}
+
+		/*!
+			\brief Get the number of used IDs.
+		*/
+		uint32_t size() const throw() {
+			return mCount;
+		}
+
+		/*!
+			\brief Check if generate can return another ID.
+		*/
+		bool exhausted() const throw() {
+			return find_unused(R ? 0 : mNext) == CAPACITY;
+		}
+
+		/*!
+			\brief Get an unused ID and mark it as used.
+			\param aID Set to the ID.
+			\return False if every ID is in use (or has been used when IDs are not reused).
+		*/
+		bool try_generate(T& aID) throw() {
+			const uint32_t id = find_unused(R ? 0 : mNext);
+			if(id == CAPACITY) return false;
+			set(id);
+			if(! R) mNext = id + 1;
+			aID = static_cast<T>(id);
+			return true;
+		}
+
+		/*!
+			\brief Free every ID.
+		*/
+		void reset() throw() {
+			mUsed.fill(0);
+			mFull.fill(0);
+			mCount = 0;
+			mNext = 0;
+		}
+
+		// Inherited from id_generator
+
+		/*!
+			\return The ID, or 0 if every ID is in use.
+			\see try_generate
+		*/
+		T generate() throw() override {
+			T id = static_cast<T>(0);
+			try_generate(id);
+			return id;
+		}
+
+		bool use(T aID) throw() override {
+			if(is_used(aID)) return false;
+			set(static_cast<uint32_t>(aID));
+			return true;
+		}
+
+		bool free(T aID) throw() override {
+			if(! is_used(aID)) return false;
+			clear(static_cast<uint32_t>(aID));
+			return true;
+		}
+
+		bool is_used(T aID) const throw() override {
+			const uint32_t id = static_cast<uint32_t>(aID);
+			return (mUsed[id / WORD_BITS] & (1ULL << (id % WORD_BITS))) != 0;
+		}
+
+		size_t generate_n(T* aIDs, size_t aCount) throw() override {
+			for(size_t i = 0; i < aCount; ++i) if(! try_generate(aIDs[i])) return i;
+			return aCount;
+		}
+	};
+}
+#endif
\ No newline at end of file
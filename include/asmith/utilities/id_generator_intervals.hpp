@@ -0,0 +1,295 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_ID_GENERATOR_INTERVALS_HPP
+#define ASMITH_UTILITIES_ID_GENERATOR_INTERVALS_HPP
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <type_traits>
+#include "id_generator.hpp"
+
+namespace asmith {
+
+	/*!
+		\brief An implementation of id_generator that stores the used IDs as a set of intervals.
+		\detail Adjacent used IDs are merged into one interval, so memory is proportional to the number of gaps rather
+		than the number of IDs. Single ID operations are O(log k) for k intervals, range operations are O(log k)
+		regardless of the size of the range.
+		\tparam T The type of ID to manage, must be an unsigned integer.
+		\tparam R True if ID codes can be reused after they have been freed.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T, bool R>
+	class id_generator_intervals : public id_generator<T> {
+	private:
+		static_assert(std::is_unsigned<T>::value, "asmith::id_generator_intervals : T must be an unsigned integer");
+
+		typedef std::map<T, T> interval_map;	//!< First ID of each interval to the last ID (inclusive)
+
+		interval_map mUsed;
+		uint64_t mCount;	//!< Number of used IDs
+		uint64_t mNext;		//!< The lowest ID that generate can return when IDs are not reused
+		bool mExhausted;	//!< Set when IDs are not reused and the maximum ID has been generated
+
+		static inline uint64_t max_id() throw() {
+			return static_cast<uint64_t>(std::numeric_limits<T>::max());
+		}
+
+		/*!
+			\brief Find the interval that contains an ID.
+			\return The interval, or mUsed.end() if the ID is not used.
+		*/
+		typename interval_map::const_iterator find(const T aID) const throw() {
+			typename interval_map::const_iterator i = mUsed.upper_bound(aID);
+			if(i == mUsed.begin()) return mUsed.end();
+			--i;
+			return i->second >= aID ? i : mUsed.end();
+		}
+
+		/*!
+			\brief Check if any ID in [aFirst, aLast] is used.
+		*/
+		bool overlaps(const T aFirst, const T aLast) const throw() {
+			typename interval_map::const_iterator i = mUsed.upper_bound(aLast);
+			if(i == mUsed.begin()) return false;
+			--i;
+			return i->second >= aFirst;
+		}
+
+		/*!
+			\brief Mark [aFirst, aLast] as used, none of the IDs can already be used.
+		*/
+		void insert(T aFirst, T aLast) {
+			typename interval_map::iterator next = mUsed.upper_bound(aFirst);
+			if(next != mUsed.end() && static_cast<uint64_t>(aLast) + 1 == static_cast<uint64_t>(next->first)) {
+				aLast = next->second;
+				next = mUsed.erase(next);
+			}
+			if(next != mUsed.begin()) {
+				typename interval_map::iterator previous = std::prev(next);
+				if(static_cast<uint64_t>(previous->second) + 1 == static_cast<uint64_t>(aFirst)) {
+					previous->second = aLast;
+					return;
+				}
+			}
+			mUsed.emplace_hint(next, aFirst, aLast);
+		}
+
+		/*!
+			\brief Mark [aFirst, aLast] as unused, all of the IDs must be in the same interval.
+		*/
+		void remove(const T aFirst, const T aLast) {
+			typename interval_map::iterator i = std::prev(mUsed.upper_bound(aFirst));
+			const T last = i->second;
+			if(i->first < aFirst) {
+				i->second = static_cast<T>(aFirst - 1);
+			}else {
+				i = mUsed.erase(i);
+			}
+			if(aLast < last) mUsed.emplace_hint(i, static_cast<T>(aLast + 1), last);
+		}
+
+		/*!
+			\brief Find the lowest unused ID at or after a position.
+			\param aID Set to the ID.
+			\param aGapEnd Set to the last unused ID of the gap that contains the result.
+			\return False if every ID at or after aFrom is used.
+		*/
+		bool find_unused(const uint64_t aFrom, uint64_t& aID, uint64_t& aGapEnd) const throw() {
+			if(aFrom > max_id()) return false;
+			uint64_t id = aFrom;
+			typename interval_map::const_iterator i = mUsed.upper_bound(static_cast<T>(id));
+			if(i != mUsed.begin()) {
+				const typename interval_map::const_iterator previous = std::prev(i);
+				if(static_cast<uint64_t>(previous->second) >= id) {
+					// Checked before incrementing so that the maximum ID of a 64 bit T does not wrap to 0
+					if(static_cast<uint64_t>(previous->second) == max_id()) return false;
+					id = static_cast<uint64_t>(previous->second) + 1;
+				}
+			}
+			aGapEnd = i == mUsed.end() ? max_id() : static_cast<uint64_t>(i->first) - 1;
+			aID = id;
+			return true;
+		}
+
+		/*!
+			\brief Move the next ID past a generated ID when IDs are not reused.
+		*/
+		void advance_next(const uint64_t aLast) throw() {
+			if(aLast == max_id()) {
+				mExhausted = true;
+			}else {
+				mNext = aLast + 1;
+			}
+		}
+
+		/*!
+			\brief Check if [aFirst, aFirst + aCount - 1] fits below the maximum ID.
+		*/
+		static inline bool in_range(const T aFirst, const T aCount) throw() {
+			return static_cast<uint64_t>(aCount) - 1 <= max_id() - static_cast<uint64_t>(aFirst);
+		}
+	public:
+		id_generator_intervals() :
+			mCount(0),
+			mNext(0),
+			mExhausted(false)
+		{}
+
+		/*!
+			\brief Get an unused ID and mark it as used.
+			\param aID Set to the ID.
+			\return False if every ID is in use (or has been used when IDs are not reused).
+		*/
+		bool try_generate(T& aID) {
+			if(! R && mExhausted) return false;
+			uint64_t id, gap_end;
+			if(! find_unused(R ? 0 : mNext, id, gap_end)) return false;
+			insert(static_cast<T>(id), static_cast<T>(id));
+			++mCount;
+			if(! R) advance_next(id);
+			aID = static_cast<T>(id);
+			return true;
+		}
+
+		/*!
+			\brief Generate a block of consecutive IDs.
+			\detail Uses the first gap that is large enough, O(k) for k intervals in the worst case.
+			\param aFirst Set to the first ID of the block.
+			\param aCount The number of IDs in the block.
+			\return False if there is no gap large enough.
+		*/
+		bool generate_range(T& aFirst, const T aCount) {
+			if(aCount == 0 || (! R && mExhausted)) return false;
+			uint64_t from = R ? 0 : mNext;
+			while(true) {
+				uint64_t id, gap_end;
+				if(! find_unused(from, id, gap_end)) return false;
+				if(gap_end - id >= static_cast<uint64_t>(aCount) - 1) {
+					const uint64_t last = id + static_cast<uint64_t>(aCount) - 1;
+					insert(static_cast<T>(id), static_cast<T>(last));
+					mCount += aCount;
+					if(! R) advance_next(last);
+					aFirst = static_cast<T>(id);
+					return true;
+				}
+				if(gap_end == max_id()) return false;
+				from = gap_end + 1;
+			}
+		}
+
+		/*!
+			\brief Get the number of used IDs.
+		*/
+		uint64_t size() const throw() {
+			return mCount;
+		}
+
+		/*!
+			\brief Get the number of intervals of used IDs.
+		*/
+		size_t interval_count() const throw() {
+			return mUsed.size();
+		}
+
+		/*!
+			\brief Call a function for each interval of used IDs, in ascending order.
+			\param aFunction Called with the first and last (inclusive) ID of each interval.
+		*/
+		template<class F>
+		void for_each_interval(F&& aFunction) const {
+			for(const typename interval_map::value_type& i : mUsed) aFunction(i.first, i.second);
+		}
+
+		// Inherited from id_generator
+
+		/*!
+			\return The ID, or 0 if every ID is in use.
+			\see try_generate
+		*/
+		T generate() throw() override {
+			T id = static_cast<T>(0);
+			try_generate(id);
+			return id;
+		}
+
+		bool use(T aID) throw() override {
+			if(overlaps(aID, aID)) return false;
+			insert(aID, aID);
+			++mCount;
+			return true;
+		}
+
+		bool free(T aID) throw() override {
+			if(find(aID) == mUsed.end()) return false;
+			remove(aID, aID);
+			--mCount;
+			return true;
+		}
+
+		bool is_used(T aID) const throw() override {
+			return find(aID) != mUsed.end();
+		}
+
+		/*!
+			\detail Fills each gap with consecutive IDs, O(n + g log k) for g gaps.
+		*/
+		size_t generate_n(T* aIDs, size_t aCount) throw() override {
+			size_t count = 0;
+			if(! R && mExhausted) return count;
+			uint64_t from = R ? 0 : mNext;
+			while(count < aCount) {
+				uint64_t id, gap_end;
+				if(! find_unused(from, id, gap_end)) break;
+				const uint64_t remaining = static_cast<uint64_t>(aCount - count);
+				uint64_t last = gap_end;
+				if(last - id >= remaining) last = id + remaining - 1;
+				insert(static_cast<T>(id), static_cast<T>(last));
+				for(uint64_t i = id; i < last; ++i) aIDs[count++] = static_cast<T>(i);
+				aIDs[count++] = static_cast<T>(last);
+				mCount += last - id + 1;
+				if(! R) advance_next(last);
+				if(last == max_id()) break;
+				from = last + 1;
+			}
+			return count;
+		}
+
+		bool use_range(T aFirst, T aCount) throw() override {
+			if(aCount == 0) return true;
+			if(! in_range(aFirst, aCount)) return false;
+			const uint64_t last = static_cast<uint64_t>(aFirst) + static_cast<uint64_t>(aCount) - 1;
+			if(overlaps(aFirst, static_cast<T>(last))) return false;
+			insert(aFirst, static_cast<T>(last));
+			mCount += aCount;
+			return true;
+		}
+
+		bool free_range(T aFirst, T aCount) throw() override {
+			if(aCount == 0) return true;
+			if(! in_range(aFirst, aCount)) return false;
+			const uint64_t last = static_cast<uint64_t>(aFirst) + static_cast<uint64_t>(aCount) - 1;
+			const typename interval_map::const_iterator i = find(aFirst);
+			if(i == mUsed.end() || static_cast<uint64_t>(i->second) < last) return false;
+			remove(aFirst, static_cast<T>(last));
+			mCount -= aCount;
+			return true;
+		}
+	};
+}
+#endif
\ No newline at end of file
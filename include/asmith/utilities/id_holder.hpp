@@ -43,7 +43,7 @@ namespace asmith {
 		\author Adam Smith
 	*/
 	template<class T>
-	class id_holder_example : public_id_holder {
+	class id_holder_example : public id_holder<T> {
 	private:
 		id_generator<T>& mGenerator;
 		const T mID;
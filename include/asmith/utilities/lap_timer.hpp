@@ -0,0 +1,224 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_LAP_TIMER_HPP
+#define ASMITH_UTILITIES_LAP_TIMER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "average.hpp"
+#include "standard_deviation.hpp"
+#include "tsc_timer.hpp"
+
+namespace asmith {
+
+	/*!
+		\brief Summary statistics of all laps with the same name or index.
+		\detail All durations are in the FORMAT units of the lap_timer that produced them.
+	*/
+	struct lap_summary {
+		std::string name;		//!< The name of the lap, or the index as a string for indexed laps
+		uint32_t index;			//!< The index of the lap, 0 for named laps
+		size_t count;			//!< Number of laps recorded
+		double total;
+		double min;
+		double max;
+		double mean;
+		double standard_deviation;	//!< Sample standard deviation, 0 if there is only one lap
+		double median;
+		double p90;
+		double p99;
+	};
+
+	/*!
+		\brief Records the time between consecutive split points into a fixed capacity buffer.
+		\detail Each call to lap stores the time since the previous split point (or start) and does not allocate, virtual
+		calls are not used. Laps are measured with tsc_clock and converted to FORMAT when summaries are requested.
+		\tparam CAPACITY The maximum number of laps that can be stored.
+		\tparam FORMAT The measurement unit of the summaries, can be any std::chrono::duration class.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<size_t CAPACITY, class FORMAT = std::chrono::nanoseconds>
+	class lap_timer {
+	public:
+		/*!
+			\brief A recorded lap.
+		*/
+		struct split {
+			const char* name;	//!< The name of the lap, or nullptr for indexed laps
+			uint32_t index;		//!< The index of the lap, 0 for named laps
+			uint64_t ticks;		//!< The duration of the lap in tsc_clock ticks
+		};
+	private:
+		std::array<split, CAPACITY> mLaps;
+		size_t mCount;		//!< Number of laps stored
+		uint64_t mLast;		//!< tsc_clock tick count at the previous split point
+		uint64_t mDropped;	//!< Number of laps that did not fit in the buffer
+
+		inline bool record(const char* const aName, const uint32_t aIndex) throw() {
+			const uint64_t now = tsc_clock::now();
+			const uint64_t ticks = now - mLast;
+			mLast = now;
+			if(mCount == CAPACITY) {
+				++mDropped;
+				return false;
+			}
+			split& s = mLaps[mCount++];
+			s.name = aName;
+			s.index = aIndex;
+			s.ticks = ticks;
+			return true;
+		}
+
+		static double to_format(const uint64_t aTicks, const double aNanosecondsPerTick) throw() {
+			const std::chrono::duration<double, std::nano> ns(static_cast<double>(aTicks) * aNanosecondsPerTick);
+			return std::chrono::duration_cast<std::chrono::duration<double, typename FORMAT::period>>(ns).count();
+		}
+
+		static double percentile(const std::vector<double>& aSorted, const double aPercentile) throw() {
+			const double rank = aPercentile * static_cast<double>(aSorted.size() - 1);
+			const size_t lower = static_cast<size_t>(rank);
+			if(lower + 1 >= aSorted.size()) return aSorted.back();
+			return aSorted[lower] + (aSorted[lower + 1] - aSorted[lower]) * (rank - static_cast<double>(lower));
+		}
+	public:
+		/*!
+			\brief Create a new lap timer, the first lap is measured from construction unless start is called.
+		*/
+		lap_timer() throw() :
+			mCount(0),
+			mLast(tsc_clock::now()),
+			mDropped(0)
+		{}
+
+		/*!
+			\brief Set the split point that the next lap is measured from, without recording a lap.
+		*/
+		inline void start() throw() {
+			mLast = tsc_clock::now();
+		}
+
+		/*!
+			\brief Record the time since the previous split point.
+			\param aIndex The index of the lap, laps with the same index are summarised together.
+			\return False if the buffer is full, the split point is still updated.
+		*/
+		inline bool lap(const uint32_t aIndex) throw() {
+			return record(nullptr, aIndex);
+		}
+
+		/*!
+			\brief Record the time since the previous split point.
+			\param aName The name of the lap, must outlive the timer (eg. a string literal). Laps with the same name are summarised together.
+			\return False if the buffer is full, the split point is still updated.
+		*/
+		inline bool lap(const char* const aName) throw() {
+			return record(aName, 0);
+		}
+
+		/*!
+			\brief Remove all recorded laps.
+		*/
+		void reset() throw() {
+			mCount = 0;
+			mDropped = 0;
+			mLast = tsc_clock::now();
+		}
+
+		/*!
+			\brief Get a recorded lap.
+			\param aIndex The position of the lap in the order they were recorded, must be less than size().
+		*/
+		const split& get(const size_t aIndex) const throw() {
+			return mLaps[aIndex];
+		}
+
+		/*!
+			\brief Get the duration of a recorded lap.
+			\param aIndex The position of the lap in the order they were recorded, must be less than size().
+			\return The duration in FORMAT units.
+		*/
+		double get_duration(const size_t aIndex) const throw() {
+			return to_format(mLaps[aIndex].ticks, tsc_clock::nanoseconds_per_tick());
+		}
+
+		size_t size() const throw() {
+			return mCount;
+		}
+
+		static size_t capacity() throw() {
+			return CAPACITY;
+		}
+
+		uint64_t get_dropped() const throw() {
+			return mDropped;
+		}
+
+		/*!
+			\brief Calculate statistics for each distinct lap.
+			\return One summary per lap name or index, in order of first appearance.
+		*/
+		std::vector<lap_summary> summarise() const {
+			const double ns_per_tick = tsc_clock::nanoseconds_per_tick();
+			std::vector<lap_summary> tmp;
+			std::vector<const split*> keys;
+			std::vector<double> durations;
+			durations.reserve(mCount);
+
+			for(size_t i = 0; i < mCount; ++i) {
+				const split& key = mLaps[i];
+				bool seen = false;
+				for(const split* j : keys) {
+					if(key.name == nullptr ? j->name == nullptr && j->index == key.index : j->name != nullptr && std::strcmp(j->name, key.name) == 0) {
+						seen = true;
+						break;
+					}
+				}
+				if(seen) continue;
+				keys.push_back(&key);
+
+				// Gather every lap with the same key
+				durations.clear();
+				for(size_t j = i; j < mCount; ++j) {
+					const split& s = mLaps[j];
+					const bool match = key.name == nullptr ? s.name == nullptr && s.index == key.index : s.name != nullptr && std::strcmp(s.name, key.name) == 0;
+					if(match) durations.push_back(to_format(s.ticks, ns_per_tick));
+				}
+				std::sort(durations.begin(), durations.end());
+
+				lap_summary summary;
+				summary.name = key.name == nullptr ? std::to_string(key.index) : std::string(key.name);
+				summary.index = key.index;
+				summary.count = durations.size();
+				summary.min = durations.front();
+				summary.max = durations.back();
+				summary.mean = asmith::mean<double>(durations.data(), durations.data() + durations.size());
+				summary.total = summary.mean * static_cast<double>(summary.count);
+				summary.standard_deviation = durations.size() < 2 ? 0.0 : standard_deviation_sample<double>(durations.data(), durations.data() + durations.size());
+				summary.median = asmith::median<double>(durations.data(), durations.data() + durations.size());
+				summary.p90 = percentile(durations, 0.9);
+				summary.p99 = percentile(durations, 0.99);
+				tmp.push_back(summary);
+			}
+			return tmp;
+		}
+	};
+}
+#endif
\ No newline at end of file
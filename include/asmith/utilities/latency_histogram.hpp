@@ -0,0 +1,390 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_LATENCY_HISTOGRAM_HPP
+#define ASMITH_UTILITIES_LATENCY_HISTOGRAM_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include "timer.hpp"
+#include "bit_operations.hpp"
+
+namespace asmith {
+
+	/*!
+		\brief A fixed memory histogram with log-linear buckets, in the style of HdrHistogram.
+		\detail Values are recorded with a relative error of at most 10^-digits across the whole trackable range.
+		Recording is O(1) (a leading-zero count, two shifts and a relaxed atomic add) and does not allocate,
+		so it can safely be called from several threads. Values above the highest trackable value are clamped.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class latency_histogram {
+	public:
+		/*!
+			\brief A range of values that share a counter.
+		*/
+		struct bucket {
+			uint64_t lowest;	//!< The lowest value in the bucket
+			uint64_t highest;	//!< The highest value in the bucket
+			uint64_t count;		//!< The number of values recorded in the bucket
+		};
+
+		/*!
+			\brief Iterates over the buckets that contain at least one value, in ascending order.
+		*/
+		class const_iterator {
+		private:
+			const latency_histogram* mHistogram;
+			size_t mIndex;
+
+			void skip_empty() throw() {
+				while(mIndex < mHistogram->mCountsLength && mHistogram->mCounts[mIndex].load(std::memory_order_relaxed) == 0) ++mIndex;
+			}
+		public:
+			const_iterator(const latency_histogram& aHistogram, const size_t aIndex) throw() :
+				mHistogram(&aHistogram),
+				mIndex(aIndex)
+			{
+				skip_empty();
+			}
+
+			bucket operator*() const throw() {
+				const uint64_t value = mHistogram->value_at_index(mIndex);
+				return bucket{value, mHistogram->highest_equivalent_value(value), mHistogram->mCounts[mIndex].load(std::memory_order_relaxed)};
+			}
+
+			const_iterator& operator++() throw() {
+				++mIndex;
+				skip_empty();
+				return *this;
+			}
+
+			bool operator==(const const_iterator& aOther) const throw() {
+				return mIndex == aOther.mIndex;
+			}
+
+			bool operator!=(const const_iterator& aOther) const throw() {
+				return mIndex != aOther.mIndex;
+			}
+		};
+	private:
+		std::unique_ptr<std::atomic<uint64_t>[]> mCounts;
+		std::atomic<uint64_t> mMin;
+		std::atomic<uint64_t> mMax;
+		uint64_t mLowest;
+		uint64_t mHighest;
+		uint64_t mSubBucketMask;
+		size_t mCountsLength;
+		int mDigits;
+		int mUnitMagnitude;
+		int mSubBucketHalfCountMagnitude;
+		int mSubBucketCount;
+		int mSubBucketHalfCount;
+		int mBucketCount;
+
+		latency_histogram(const latency_histogram&) = delete;
+		latency_histogram& operator=(const latency_histogram&) = delete;
+
+		size_t index_of(const uint64_t aValue) const throw() {
+			const int bucket_index = 64 - implementation::count_leading_zeros(aValue | mSubBucketMask) - (mUnitMagnitude + mSubBucketHalfCountMagnitude + 1);
+			const int sub_bucket_index = static_cast<int>(aValue >> (bucket_index + mUnitMagnitude));
+			return static_cast<size_t>(((bucket_index + 1) << mSubBucketHalfCountMagnitude) + (sub_bucket_index - mSubBucketHalfCount));
+		}
+
+		uint64_t value_at_index(const size_t aIndex) const throw() {
+			int bucket_index = static_cast<int>(aIndex >> mSubBucketHalfCountMagnitude) - 1;
+			int sub_bucket_index = static_cast<int>(aIndex & (mSubBucketHalfCount - 1)) + mSubBucketHalfCount;
+			if(bucket_index < 0) {
+				sub_bucket_index -= mSubBucketHalfCount;
+				bucket_index = 0;
+			}
+			return static_cast<uint64_t>(sub_bucket_index) << (bucket_index + mUnitMagnitude);
+		}
+
+		uint64_t size_of_equivalent_range(const uint64_t aValue) const throw() {
+			const int bucket_index = 64 - implementation::count_leading_zeros(aValue | mSubBucketMask) - (mUnitMagnitude + mSubBucketHalfCountMagnitude + 1);
+			const int sub_bucket_index = static_cast<int>(aValue >> (bucket_index + mUnitMagnitude));
+			return 1ULL << (mUnitMagnitude + (sub_bucket_index >= mSubBucketCount ? bucket_index + 1 : bucket_index));
+		}
+
+		uint64_t clamp(const uint64_t aValue) const throw() {
+			return aValue > mHighest ? mHighest : aValue;
+		}
+
+		void update_min_max(const uint64_t aValue) throw() {
+			uint64_t current = mMin.load(std::memory_order_relaxed);
+			while(aValue < current && ! mMin.compare_exchange_weak(current, aValue, std::memory_order_relaxed));
+			current = mMax.load(std::memory_order_relaxed);
+			while(aValue > current && ! mMax.compare_exchange_weak(current, aValue, std::memory_order_relaxed));
+		}
+	public:
+		/*!
+			\brief Create a new histogram.
+			\param aLowest The smallest value that can be distinguished from 0, at least 1.
+			\param aHighest The largest value that can be recorded, at least 2 * aLowest.
+			\param aDigits The number of significant decimal digits to preserve, between 1 and 5.
+		*/
+		latency_histogram(const uint64_t aLowest, const uint64_t aHighest, const int aDigits) :
+			mMin(std::numeric_limits<uint64_t>::max()),
+			mMax(0),
+			mLowest(aLowest < 1 ? 1 : aLowest),
+			mHighest(aHighest < mLowest * 2 ? mLowest * 2 : aHighest),
+			mDigits(aDigits < 1 ? 1 : aDigits > 5 ? 5 : aDigits)
+		{
+			uint64_t largest_single_unit = 2;
+			for(int i = 0; i < mDigits; ++i) largest_single_unit *= 10;
+
+			const int sub_bucket_count_magnitude = 64 - implementation::count_leading_zeros(largest_single_unit - 1);
+			mSubBucketHalfCountMagnitude = (sub_bucket_count_magnitude > 1 ? sub_bucket_count_magnitude : 1) - 1;
+			mUnitMagnitude = 63 - implementation::count_leading_zeros(mLowest);
+			mSubBucketCount = 1 << (mSubBucketHalfCountMagnitude + 1);
+			mSubBucketHalfCount = mSubBucketCount / 2;
+			mSubBucketMask = static_cast<uint64_t>(mSubBucketCount - 1) << mUnitMagnitude;
+
+			uint64_t smallest_untrackable = static_cast<uint64_t>(mSubBucketCount) << mUnitMagnitude;
+			mBucketCount = 1;
+			while(smallest_untrackable <= mHighest) {
+				if(smallest_untrackable > std::numeric_limits<uint64_t>::max() / 2) {
+					++mBucketCount;
+					break;
+				}
+				smallest_untrackable <<= 1;
+				++mBucketCount;
+			}
+
+			mCountsLength = static_cast<size_t>(mBucketCount + 1) * static_cast<size_t>(mSubBucketHalfCount);
+			mCounts.reset(new std::atomic<uint64_t>[mCountsLength]);
+			reset();
+		}
+
+		/*!
+			\brief Record a value, safe to call from several threads at once.
+			\param aValue The value to record.
+			\param aCount The number of instances of aValue.
+		*/
+		inline void record(const uint64_t aValue, const uint64_t aCount = 1) throw() {
+			const uint64_t value = clamp(aValue);
+			mCounts[index_of(value)].fetch_add(aCount, std::memory_order_relaxed);
+			update_min_max(value);
+		}
+
+		/*!
+			\brief Record a value without an atomic read-modify-write.
+			\detail Cheaper than record, but must only be used while no other thread is writing to the histogram.
+			\param aValue The value to record.
+			\param aCount The number of instances of aValue.
+		*/
+		inline void record_single_thread(const uint64_t aValue, const uint64_t aCount = 1) throw() {
+			const uint64_t value = clamp(aValue);
+			std::atomic<uint64_t>& counter = mCounts[index_of(value)];
+			counter.store(counter.load(std::memory_order_relaxed) + aCount, std::memory_order_relaxed);
+			if(value < mMin.load(std::memory_order_relaxed)) mMin.store(value, std::memory_order_relaxed);
+			if(value > mMax.load(std::memory_order_relaxed)) mMax.store(value, std::memory_order_relaxed);
+		}
+
+		/*!
+			\brief Add the counts from another histogram to this one.
+			\detail Typically used to combine per-thread histograms.
+			\param aOther The histogram to merge, may have a different configuration.
+		*/
+		void merge(const latency_histogram& aOther) throw() {
+			const bool same_layout = mCountsLength == aOther.mCountsLength && mUnitMagnitude == aOther.mUnitMagnitude && mSubBucketCount == aOther.mSubBucketCount;
+			for(size_t i = 0; i < aOther.mCountsLength; ++i) {
+				const uint64_t count = aOther.mCounts[i].load(std::memory_order_relaxed);
+				if(count == 0) continue;
+				if(same_layout) {
+					mCounts[i].fetch_add(count, std::memory_order_relaxed);
+				}else {
+					mCounts[index_of(clamp(aOther.value_at_index(i)))].fetch_add(count, std::memory_order_relaxed);
+				}
+			}
+			if(aOther.total_count() > 0) {
+				update_min_max(clamp(aOther.min()));
+				update_min_max(clamp(aOther.max()));
+			}
+		}
+
+		/*!
+			\brief Remove all recorded values.
+		*/
+		void reset() throw() {
+			for(size_t i = 0; i < mCountsLength; ++i) mCounts[i].store(0, std::memory_order_relaxed);
+			mMin.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+			mMax.store(0, std::memory_order_relaxed);
+		}
+
+		/*!
+			\brief Get the value at a percentile.
+			\param aPercentile The percentile, between 0 and 100 (eg. 99.9).
+			\return The highest value that is equivalent to the recorded value at aPercentile, or 0 if the histogram is empty.
+		*/
+		uint64_t value_at_percentile(const double aPercentile) const throw() {
+			const double percentile = aPercentile < 0.0 ? 0.0 : aPercentile > 100.0 ? 100.0 : aPercentile;
+			const uint64_t total = total_count();
+			uint64_t target = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total)));
+			if(target < 1) target = 1;
+
+			uint64_t count = 0;
+			for(size_t i = 0; i < mCountsLength; ++i) {
+				count += mCounts[i].load(std::memory_order_relaxed);
+				if(count >= target) return std::min(highest_equivalent_value(value_at_index(i)), max());
+			}
+			return 0;
+		}
+
+		/*!
+			\brief Get the percentage of recorded values that are less than or equal to a value.
+			\param aValue The value to check.
+			\return The percentile of aValue, between 0 and 100.
+		*/
+		double percentile_of(const uint64_t aValue) const throw() {
+			const uint64_t total = total_count();
+			if(total == 0) return 0.0;
+			const size_t end = index_of(clamp(aValue));
+			uint64_t count = 0;
+			for(size_t i = 0; i <= end; ++i) count += mCounts[i].load(std::memory_order_relaxed);
+			return static_cast<double>(count) * 100.0 / static_cast<double>(total);
+		}
+
+		/*!
+			\brief Calculate the mean of the recorded values, using the midpoint of each bucket.
+		*/
+		double mean() const throw() {
+			const uint64_t total = total_count();
+			if(total == 0) return 0.0;
+			double sum = 0.0;
+			for(const bucket i : *this) sum += (static_cast<double>(i.lowest) + static_cast<double>(i.highest)) * 0.5 * static_cast<double>(i.count);
+			return sum / static_cast<double>(total);
+		}
+
+		/*!
+			\brief Calculate the population standard deviation of the recorded values, using the midpoint of each bucket.
+		*/
+		double standard_deviation() const throw() {
+			const uint64_t total = total_count();
+			if(total == 0) return 0.0;
+			const double m = mean();
+			double sum = 0.0;
+			for(const bucket i : *this) {
+				const double dif = (static_cast<double>(i.lowest) + static_cast<double>(i.highest)) * 0.5 - m;
+				sum += dif * dif * static_cast<double>(i.count);
+			}
+			return std::sqrt(sum / static_cast<double>(total));
+		}
+
+		/*!
+			\brief Get the largest value that would be recorded in the same bucket as a value.
+		*/
+		uint64_t highest_equivalent_value(const uint64_t aValue) const throw() {
+			return lowest_equivalent_value(aValue) + size_of_equivalent_range(aValue) - 1;
+		}
+
+		/*!
+			\brief Get the smallest value that would be recorded in the same bucket as a value.
+		*/
+		uint64_t lowest_equivalent_value(const uint64_t aValue) const throw() {
+			const int bucket_index = 64 - implementation::count_leading_zeros(aValue | mSubBucketMask) - (mUnitMagnitude + mSubBucketHalfCountMagnitude + 1);
+			const uint64_t sub_bucket_index = aValue >> (bucket_index + mUnitMagnitude);
+			return sub_bucket_index << (bucket_index + mUnitMagnitude);
+		}
+
+		uint64_t total_count() const throw() {
+			uint64_t tmp = 0;
+			for(size_t i = 0; i < mCountsLength; ++i) tmp += mCounts[i].load(std::memory_order_relaxed);
+			return tmp;
+		}
+
+		uint64_t min() const throw() {
+			const uint64_t tmp = mMin.load(std::memory_order_relaxed);
+			return tmp == std::numeric_limits<uint64_t>::max() ? 0 : tmp;
+		}
+
+		uint64_t max() const throw() {
+			return mMax.load(std::memory_order_relaxed);
+		}
+
+		uint64_t lowest_trackable_value() const throw() {
+			return mLowest;
+		}
+
+		uint64_t highest_trackable_value() const throw() {
+			return mHighest;
+		}
+
+		int significant_digits() const throw() {
+			return mDigits;
+		}
+
+		/*!
+			\brief Get the amount of memory used by the counters.
+		*/
+		size_t memory_size() const throw() {
+			return mCountsLength * sizeof(std::atomic<uint64_t>);
+		}
+
+		const_iterator begin() const throw() {
+			return const_iterator(*this, 0);
+		}
+
+		const_iterator end() const throw() {
+			return const_iterator(*this, mCountsLength);
+		}
+	};
+
+	/*!
+		\brief Records the lifetime of a scope into a latency_histogram.
+		\detail The elapsed time is measured with timer and recorded when the object is destroyed.
+		\tparam FORMAT The unit to record in, can be any std::chrono::duration class.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class FORMAT = std::chrono::microseconds>
+	class scoped_histogram_timer {
+	private:
+		latency_histogram& mHistogram;
+		timer<FORMAT> mTimer;
+
+		scoped_histogram_timer(const scoped_histogram_timer&) = delete;
+		scoped_histogram_timer& operator=(const scoped_histogram_timer&) = delete;
+	public:
+		/*!
+			\brief Start timing.
+			\param aHistogram The histogram to record into.
+		*/
+		explicit scoped_histogram_timer(latency_histogram& aHistogram) throw() :
+			mHistogram(aHistogram)
+		{
+			mTimer.start();
+		}
+
+		/*!
+			\brief Stop timing and record the elapsed time.
+		*/
+		~scoped_histogram_timer() throw() {
+			const int64_t elapsed = mTimer.get_elapsed_time();
+			mHistogram.record(elapsed < 0 ? 0 : static_cast<uint64_t>(elapsed));
+		}
+
+		timer<FORMAT>& get_timer() throw() {
+			return mTimer;
+		}
+	};
+}
+#endif
\ No newline at end of file
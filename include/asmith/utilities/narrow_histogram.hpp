@@ -0,0 +1,368 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_NARROW_HISTOGRAM_HPP
+#define ASMITH_UTILITIES_NARROW_HISTOGRAM_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "parallel_reduction.hpp"
+
+namespace asmith {
+
+	namespace implementation {
+		/*!
+			\brief True if T has few enough values to be counted with a flat array instead of a hash map.
+		*/
+		template<class T>
+		struct is_small_domain {
+			enum : bool {
+				value = std::is_integral<T>::value && ! std::is_same<T, bool>::value && sizeof(T) <= 2
+			};
+		};
+
+		enum : size_t {
+			HISTOGRAM_PARTITION_SIZE = 1 << 20,	//!< Values counted by each thread before partial histograms are merged
+			HISTOGRAM_CHUNK_SIZE = 1 << 30		//!< Values counted into 32-bit sub-histograms before they are flushed
+		};
+
+		template<class T, class I, class KEY>
+		void count_values(I aBegin, const size_t aSize, uint64_t* const aCounts, const KEY& aKey, std::false_type) {
+			for(size_t i = 0; i < aSize; ++i, ++aBegin) ++aCounts[aKey(static_cast<T>(*aBegin))];
+		}
+
+		/*!
+			\brief Count 8-bit values into four interleaved sub-histograms.
+			\detail Runs of equal values would otherwise serialise on a single counter through store-to-load forwarding.
+		*/
+		template<class T, class I, class KEY>
+		void count_values(const I aValues, const size_t aSize, uint64_t* const aCounts, const KEY& aKey, std::true_type) {
+			uint32_t sub[256 * 4];
+			for(size_t offset = 0; offset < aSize; offset += HISTOGRAM_CHUNK_SIZE) {
+				const size_t size = aSize - offset < HISTOGRAM_CHUNK_SIZE ? aSize - offset : HISTOGRAM_CHUNK_SIZE;
+				const I values = aValues + offset;
+				std::fill(sub, sub + 256 * 4, 0);
+				uint32_t* const c0 = sub;
+				uint32_t* const c1 = c0 + 256;
+				uint32_t* const c2 = c1 + 256;
+				uint32_t* const c3 = c2 + 256;
+				size_t i = 0;
+				for(const size_t end = size - size % 4; i < end; i += 4) {
+					++c0[aKey(static_cast<T>(values[i]))];
+					++c1[aKey(static_cast<T>(values[i + 1]))];
+					++c2[aKey(static_cast<T>(values[i + 2]))];
+					++c3[aKey(static_cast<T>(values[i + 3]))];
+				}
+				for(; i < size; ++i) ++c0[aKey(static_cast<T>(values[i]))];
+				for(size_t j = 0; j < 256; ++j) aCounts[j] += static_cast<uint64_t>(c0[j]) + c1[j] + c2[j] + c3[j];
+			}
+		}
+
+		/*!
+			\brief Count the values in a range into a histogram.
+			\param aBegin The first element.
+			\param aSize The number of elements to count.
+			\param aCounts The histogram to add to, indexed by aKey.
+			\param aKey Maps a value to its index in aCounts.
+		*/
+		template<class T, class I, class KEY>
+		void count_values(const I aBegin, const size_t aSize, uint64_t* const aCounts, const KEY& aKey) {
+			typedef typename std::iterator_traits<I>::value_type value_t;
+			count_values<T, I, KEY>(aBegin, aSize, aCounts, aKey, std::integral_constant<bool,
+				std::is_pointer<I>::value && sizeof(value_t) == 1 && sizeof(T) == 1
+			>());
+		}
+	}
+
+	/*!
+		\brief A counting histogram over every possible value of an integer type of 16 bits or less.
+		\detail Built with a single O(n) counting pass, after which any number of order statistics, percentiles and the mode
+		can be read without sorting or copying the data.
+		\tparam T The type of value to count, must be an integer type of 16 bits or less.
+		\tparam ALLOC The allocator used for the counts.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T, class ALLOC = std::allocator<uint64_t>>
+	class narrow_histogram {
+		static_assert(implementation::is_small_domain<T>::value, "asmith::narrow_histogram : T must be an integer type of 16 bits or less");
+	public:
+		enum : size_t {
+			DOMAIN_SIZE = static_cast<size_t>(1) << (sizeof(T) * 8)
+		};
+	private:
+		typedef typename std::make_unsigned<T>::type unsigned_t;
+
+		enum : unsigned_t {
+			SIGN_BIAS = std::is_signed<T>::value ? static_cast<unsigned_t>(1) << (sizeof(T) * 8 - 1) : 0
+		};
+
+		/*!
+			\brief Maps values to histogram indices so that the indices are in the same order as the values.
+		*/
+		struct key {
+			size_t operator()(const T aValue) const throw() {
+				return static_cast<size_t>(static_cast<unsigned_t>(static_cast<unsigned_t>(aValue) ^ SIGN_BIAS));
+			}
+		};
+
+		std::vector<uint64_t, ALLOC> mCounts;	//!< Number of instances of each value, indexed by key
+		uint64_t mTotal;				//!< Number of values counted
+
+		static T value_of(const size_t aIndex) throw() {
+			return static_cast<T>(static_cast<unsigned_t>(static_cast<unsigned_t>(aIndex) ^ SIGN_BIAS));
+		}
+
+		template<class I>
+		void count(const I aBegin, const I aEnd, std::input_iterator_tag) {
+			size_t size = 0;
+			for(I i = aBegin; i != aEnd; ++i, ++size) ++mCounts[key()(static_cast<T>(*i))];
+			mTotal += size;
+		}
+
+		template<class I>
+		void count(const I aBegin, const I aEnd, std::random_access_iterator_tag) {
+			const size_t size = static_cast<size_t>(aEnd - aBegin);
+			implementation::count_values<T>(aBegin, size, mCounts.data(), key());
+			mTotal += size;
+		}
+
+		/*!
+			\brief Count a range in partitions, each thread counts into a private histogram that is then added.
+		*/
+		template<class I>
+		void count_parallel(thread_pool& aPool, const I aBegin, const size_t aSize, const size_t aPartitionSize, const size_t aThreads) {
+			const size_t partitions = (aSize + aPartitionSize - 1) / aPartitionSize;
+			std::vector<std::vector<uint64_t>> partials(partitions);
+			implementation::for_each_partition(aPool, partitions, aThreads, [&](const size_t aIndex) {
+				const size_t begin = aIndex * aPartitionSize;
+				const size_t count = aSize - begin < aPartitionSize ? aSize - begin : aPartitionSize;
+				partials[aIndex].resize(DOMAIN_SIZE, 0);
+				implementation::count_values<T>(aBegin + begin, count, partials[aIndex].data(), key());
+			});
+
+			// Counting is exact, so the order that partial histograms are added does not affect the result
+			for(const std::vector<uint64_t>& i : partials) {
+				for(size_t j = 0; j < DOMAIN_SIZE; ++j) mCounts[j] += i[j];
+			}
+			mTotal += aSize;
+		}
+	public:
+		/*!
+			\brief Create an empty histogram.
+		*/
+		narrow_histogram() :
+			mCounts(DOMAIN_SIZE, 0),
+			mTotal(0)
+		{}
+
+		/*!
+			\brief Create an empty histogram.
+			\param aAllocator The allocator used for the counts.
+		*/
+		explicit narrow_histogram(const ALLOC& aAllocator) :
+			mCounts(DOMAIN_SIZE, 0, aAllocator),
+			mTotal(0)
+		{}
+
+		/*!
+			\brief Create a histogram of a range.
+			\param aBegin The first element.
+			\param aEnd The end of the range.
+			\param aAllocator The allocator used for the counts.
+		*/
+		template<class I>
+		narrow_histogram(const I aBegin, const I aEnd, const ALLOC& aAllocator = ALLOC()) :
+			mCounts(DOMAIN_SIZE, 0, aAllocator),
+			mTotal(0)
+		{
+			add(aBegin, aEnd);
+		}
+
+		/*!
+			\brief Create a histogram of a range, optionally using several threads.
+			\detail Each thread counts its partitions into a private histogram, the histograms are then added together.
+			\param aPolicy How the work is split across threads.
+			\param aBegin The first element, must be a random access iterator.
+			\param aEnd The end of the range.
+		*/
+		template<class I>
+		narrow_histogram(const reduction_policy aPolicy, const I aBegin, const I aEnd) :
+			mCounts(DOMAIN_SIZE, 0),
+			mTotal(0)
+		{
+			const size_t size = static_cast<size_t>(aEnd - aBegin);
+			if(aPolicy == reduction_policy::SERIAL || size < implementation::HISTOGRAM_PARTITION_SIZE) {
+				add(aBegin, aEnd);
+				return;
+			}
+
+			const size_t threads = implementation::reduction_threads();
+			const size_t partition_size = aPolicy == reduction_policy::DETERMINISTIC_PARALLEL ?
+				static_cast<size_t>(implementation::HISTOGRAM_PARTITION_SIZE) : (size + threads - 1) / threads;
+			count_parallel(thread_pool::get_default(), aBegin, size, partition_size, threads);
+		}
+
+		/*!
+			\brief Create a histogram of a range using the threads of a pool.
+			\param aPool The pool to run on.
+			\param aBegin The first element, must be a random access iterator.
+			\param aEnd The end of the range.
+		*/
+		template<class I>
+		narrow_histogram(thread_pool& aPool, const I aBegin, const I aEnd) :
+			mCounts(DOMAIN_SIZE, 0),
+			mTotal(0)
+		{
+			const size_t size = static_cast<size_t>(aEnd - aBegin);
+			const size_t threads = aPool.get_concurrency();
+			if(size < implementation::HISTOGRAM_PARTITION_SIZE || threads == 1) {
+				add(aBegin, aEnd);
+				return;
+			}
+			count_parallel(aPool, aBegin, size, (size + threads - 1) / threads, threads);
+		}
+
+		/*!
+			\brief Count the values in a range.
+			\param aBegin The first element.
+			\param aEnd The end of the range.
+		*/
+		template<class I>
+		void add(const I aBegin, const I aEnd) {
+			count(aBegin, aEnd, typename std::iterator_traits<I>::iterator_category());
+		}
+
+		/*!
+			\brief Count a single value.
+		*/
+		void add(const T aValue) throw() {
+			++mCounts[key()(aValue)];
+			++mTotal;
+		}
+
+		/*!
+			\brief Get the number of instances of a value.
+		*/
+		uint64_t count(const T aValue) const throw() {
+			return mCounts[key()(aValue)];
+		}
+
+		/*!
+			\brief Get the value that would be at a position if the values were sorted.
+			\param aIndex The position, must be less than size().
+		*/
+		T order_statistic(uint64_t aIndex) const throw() {
+			for(size_t i = 0; i < DOMAIN_SIZE; ++i) {
+				if(aIndex < mCounts[i]) return value_of(i);
+				aIndex -= mCounts[i];
+			}
+			return value_of(DOMAIN_SIZE - 1);
+		}
+
+		/*!
+			\brief Calculate a percentile using linear interpolation between the closest ranks.
+			\param aPercentile The percentile, between 0 and 1.
+			\return The interpolated value, or 0 if the histogram is empty.
+		*/
+		double percentile(const double aPercentile) const throw() {
+			if(mTotal == 0) return 0.0;
+			const double p = aPercentile < 0.0 ? 0.0 : aPercentile > 1.0 ? 1.0 : aPercentile;
+			const double rank = p * static_cast<double>(mTotal - 1);
+			const uint64_t lower = static_cast<uint64_t>(rank);
+			const double a = static_cast<double>(order_statistic(lower));
+			if(lower + 1 >= mTotal) return a;
+			const double b = static_cast<double>(order_statistic(lower + 1));
+			return a + (b - a) * (rank - static_cast<double>(lower));
+		}
+
+		/*!
+			\brief Calculate several percentiles in a single walk over the histogram.
+			\param aPercentiles The percentiles to calculate between 0 and 1, in ascending order.
+			\param aCount The number of percentiles.
+			\param aOutput Receives the value of each percentile.
+		*/
+		void percentiles(const double* const aPercentiles, const size_t aCount, double* const aOutput) const throw() {
+			if(mTotal == 0) {
+				for(size_t i = 0; i < aCount; ++i) aOutput[i] = 0.0;
+				return;
+			}
+
+			size_t bin = 0;
+			uint64_t before = 0;	// Number of values in bins before bin
+			const auto find = [&](const uint64_t aIndex)->double {
+				while(before + mCounts[bin] <= aIndex) {
+					before += mCounts[bin];
+					++bin;
+				}
+				return static_cast<double>(value_of(bin));
+			};
+
+			for(size_t i = 0; i < aCount; ++i) {
+				const double p = aPercentiles[i] < 0.0 ? 0.0 : aPercentiles[i] > 1.0 ? 1.0 : aPercentiles[i];
+				const double rank = p * static_cast<double>(mTotal - 1);
+				const uint64_t lower = static_cast<uint64_t>(rank);
+				const double a = find(lower);
+				const double b = lower + 1 < mTotal ? find(lower + 1) : a;
+				aOutput[i] = a + (b - a) * (rank - static_cast<double>(lower));
+			}
+		}
+
+		/*!
+			\brief Calculate the median, using the same definition as asmith::median.
+			\detail For an even number of values the two middle values are averaged in the arithmetic of T.
+		*/
+		T median() const throw() {
+			if(mTotal == 0) return static_cast<T>(0);
+			const uint64_t mid = mTotal / 2;
+			if((mTotal & 1) != 0) return order_statistic(mid);
+			return static_cast<T>((order_statistic(mid - 1) + order_statistic(mid)) / static_cast<T>(2));
+		}
+
+		/*!
+			\brief Find the most common value.
+			\return The most common value, if several values share the highest count then the smallest is returned.
+		*/
+		T mode() const throw() {
+			size_t best = 0;
+			for(size_t i = 1; i < DOMAIN_SIZE; ++i) if(mCounts[i] > mCounts[best]) best = i;
+			return value_of(best);
+		}
+
+		T min() const throw() {
+			for(size_t i = 0; i < DOMAIN_SIZE; ++i) if(mCounts[i] != 0) return value_of(i);
+			return static_cast<T>(0);
+		}
+
+		T max() const throw() {
+			for(size_t i = DOMAIN_SIZE; i > 0; --i) if(mCounts[i - 1] != 0) return value_of(i - 1);
+			return static_cast<T>(0);
+		}
+
+		uint64_t size() const throw() {
+			return mTotal;
+		}
+
+		void clear() throw() {
+			std::fill(mCounts.begin(), mCounts.end(), 0);
+			mTotal = 0;
+		}
+	};
+}
+#endif
\ No newline at end of file
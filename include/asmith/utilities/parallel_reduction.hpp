@@ -0,0 +1,158 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_PARALLEL_REDUCTION_HPP
+#define ASMITH_UTILITIES_PARALLEL_REDUCTION_HPP
+
+#include <atomic>
+#include <vector>
+#include "reduction.hpp"
+#include "thread_pool.hpp"
+
+namespace asmith {
+
+	/*!
+		\brief Controls how a reduction is split across threads.
+	*/
+	enum class reduction_policy {
+		SERIAL,					//!< Run on the calling thread
+		PARALLEL,				//!< Split into one partition per hardware thread, reproducible on the same machine
+		DETERMINISTIC_PARALLEL	//!< Split into fixed size partitions, bit-identical results regardless of the thread count
+	};
+
+	namespace implementation {
+		enum : size_t {
+			PARALLEL_MIN_SIZE = 1 << 16,			//!< Ranges smaller than this are always reduced serially
+			DETERMINISTIC_PARTITION_SIZE = 1 << 18	//!< Partition size used by reduction_policy::DETERMINISTIC_PARALLEL
+		};
+
+		/*!
+			\brief Combine partial results in a balanced binary tree, in index order.
+		*/
+		inline moments<double> merge_pairwise(const moments<double>* const aPartials, const size_t aCount) throw() {
+			if(aCount == 0) return moments<double>();
+			if(aCount == 1) return aPartials[0];
+			const size_t half = aCount / 2;
+			moments<double> tmp = merge_pairwise(aPartials, half);
+			tmp.merge(merge_pairwise(aPartials + half, aCount - half));
+			return tmp;
+		}
+
+		/*!
+			\brief Call a function once for each partition, spread across the threads of a pool.
+			\detail Partitions are handed out dynamically, the calling thread also processes partitions.
+			\param aPool The pool to run on.
+			\param aPartitions The number of partitions.
+			\param aThreads The maximum number of threads to use, including the calling thread.
+			\param aFunction Called with the index of each partition.
+		*/
+		template<class F>
+		void for_each_partition(thread_pool& aPool, const size_t aPartitions, const size_t aThreads, const F& aFunction) {
+			std::atomic<size_t> next(0);
+			const auto worker = [&]() {
+				size_t i = next.fetch_add(1, std::memory_order_relaxed);
+				while(i < aPartitions) {
+					aFunction(i);
+					i = next.fetch_add(1, std::memory_order_relaxed);
+				}
+			};
+
+			size_t threads = aThreads < aPartitions ? aThreads : aPartitions;
+			if(threads > aPool.get_concurrency()) threads = aPool.get_concurrency();
+			task_group group(aPool);
+			for(size_t i = 1; i < threads; ++i) group.run(worker);
+			worker();
+			group.wait();
+		}
+
+		/*!
+			\brief Call a function once for each partition, spread across the threads of the default pool.
+			\see for_each_partition
+		*/
+		template<class F>
+		void for_each_partition(const size_t aPartitions, const size_t aThreads, const F& aFunction) {
+			for_each_partition(thread_pool::get_default(), aPartitions, aThreads, aFunction);
+		}
+
+		/*!
+			\brief Get the number of threads to use for a reduction.
+		*/
+		inline size_t reduction_threads() {
+			return thread_pool::get_default().get_concurrency();
+		}
+
+		/*!
+			\brief Calculate the moments of a range by splitting it into partitions that are reduced on separate threads.
+			\detail Each result is stored by partition index and the results are merged in a fixed order, so the output
+			only depends on the partition size and never on thread scheduling.
+			\param aPool The pool to run on.
+			\param aBegin The first element, must be a random access iterator.
+			\param aSize The number of elements in the range.
+			\param aPartitionSize The number of elements in each partition.
+			\param aThreads The maximum number of threads to use, including the calling thread.
+		*/
+		template<class I>
+		moments<double> parallel_moments(thread_pool& aPool, const I aBegin, const size_t aSize, size_t aPartitionSize, const size_t aThreads) {
+			// Keep partition boundaries aligned with the serial block boundaries
+			aPartitionSize = ((aPartitionSize + MOMENTS_BLOCK_SIZE - 1) / MOMENTS_BLOCK_SIZE) * MOMENTS_BLOCK_SIZE;
+			const size_t partitions = (aSize + aPartitionSize - 1) / aPartitionSize;
+			std::vector<moments<double>> partials(partitions);
+
+			for_each_partition(aPool, partitions, aThreads, [&](const size_t aIndex) {
+				const size_t begin = aIndex * aPartitionSize;
+				const size_t size = aSize - begin < aPartitionSize ? aSize - begin : aPartitionSize;
+				partials[aIndex] = compute_moments(aBegin + begin, size);
+			});
+
+			return merge_pairwise(partials.data(), partitions);
+		}
+
+		/*!
+			\brief Calculate the moments of a range using a reduction policy.
+			\param aPolicy How the work is split across threads.
+			\param aBegin The first element, must be a random access iterator.
+			\param aEnd The end of the range.
+		*/
+		template<class I>
+		moments<double> compute_moments(const reduction_policy aPolicy, const I aBegin, const I aEnd) {
+			const size_t size = static_cast<size_t>(aEnd - aBegin);
+
+			if(aPolicy == reduction_policy::SERIAL || size < PARALLEL_MIN_SIZE) {
+				return compute_moments(aBegin, size);
+			}
+
+			thread_pool& pool = thread_pool::get_default();
+			const size_t threads = pool.get_concurrency();
+			if(aPolicy == reduction_policy::DETERMINISTIC_PARALLEL) {
+				return parallel_moments(pool, aBegin, size, DETERMINISTIC_PARTITION_SIZE, threads);
+			}else {
+				return parallel_moments(pool, aBegin, size, (size + threads - 1) / threads, threads);
+			}
+		}
+
+		/*!
+			\brief Calculate the moments of a range using the threads of a pool.
+			\param aPool The pool to run on.
+			\param aBegin The first element, must be a random access iterator.
+			\param aEnd The end of the range.
+		*/
+		template<class I>
+		moments<double> compute_moments(thread_pool& aPool, const I aBegin, const I aEnd) {
+			const size_t size = static_cast<size_t>(aEnd - aBegin);
+			const size_t threads = aPool.get_concurrency();
+			if(size < PARALLEL_MIN_SIZE || threads == 1) return compute_moments(aBegin, size);
+			return parallel_moments(aPool, aBegin, size, (size + threads - 1) / threads, threads);
+		}
+	}
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,280 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_PROFILER_HPP
+#define ASMITH_UTILITIES_PROFILER_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "tsc_timer.hpp"
+
+namespace asmith {
+
+	/*!
+		\brief A completed profiling zone.
+		\detail Names and categories must be string literals (or otherwise outlive the profiler), only the pointers are stored.
+	*/
+	struct profiler_event {
+		const char* name;		//!< The name of the zone
+		const char* category;	//!< The category of the zone
+		const char* arg_name;	//!< The name of the optional argument, or nullptr
+		int64_t arg_value;		//!< The value of the optional argument
+		uint64_t begin;			//!< tsc_clock tick count when the zone was entered
+		uint64_t end;			//!< tsc_clock tick count when the zone was exited
+	};
+
+	/*!
+		\brief A fixed capacity, lock-free, single producer single consumer queue of profiler events.
+		\detail Each thread writes to its own buffer, the collector drains it. If the buffer is full then new events are
+		dropped and counted rather than blocking the thread that is being profiled.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class profiler_buffer {
+	private:
+		std::unique_ptr<profiler_event[]> mEvents;
+		const uint64_t mMask;
+		const uint32_t mThreadID;
+		uint8_t mPadding0[64];					//!< Keeps the writer's members on their own cache line
+		std::atomic<uint64_t> mHead;			//!< Next write position, only written by the owning thread
+		std::atomic<uint64_t> mDropped;			//!< Number of events that did not fit, only written by the owning thread
+		uint8_t mPadding1[64];					//!< Keeps the collector's members on their own cache line
+		std::atomic<uint64_t> mTail;			//!< Next read position, only written by the collector
+		std::atomic<bool> mRetired;				//!< Set when the owning thread exits
+
+		profiler_buffer(const profiler_buffer&) = delete;
+		profiler_buffer& operator=(const profiler_buffer&) = delete;
+	public:
+		/*!
+			\brief Create a new buffer.
+			\param aCapacity The number of events, rounded up to a power of 2.
+			\param aThreadID The ID of the thread that owns the buffer.
+		*/
+		profiler_buffer(const size_t aCapacity, const uint32_t aThreadID);
+
+		/*!
+			\brief Add an event, only called by the owning thread.
+		*/
+		inline void push(const profiler_event& aEvent) throw() {
+			const uint64_t head = mHead.load(std::memory_order_relaxed);
+			if(head - mTail.load(std::memory_order_acquire) > mMask) {
+				mDropped.store(mDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				return;
+			}
+			mEvents[head & mMask] = aEvent;
+			mHead.store(head + 1, std::memory_order_release);
+		}
+
+		/*!
+			\brief Remove all events that have been added, only called by the collector.
+			\param aOutput The events are appended to this vector.
+			\return The number of events removed.
+		*/
+		size_t drain(std::vector<profiler_event>& aOutput);
+
+		void retire() throw() {
+			mRetired.store(true, std::memory_order_release);
+		}
+
+		bool is_retired() const throw() {
+			return mRetired.load(std::memory_order_acquire);
+		}
+
+		bool empty() const throw() {
+			return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_relaxed);
+		}
+
+		uint32_t get_thread_id() const throw() {
+			return mThreadID;
+		}
+
+		uint64_t get_dropped() const throw() {
+			return mDropped.load(std::memory_order_relaxed);
+		}
+	};
+
+	/*!
+		\brief Collects profiling zones from all threads and produces reports.
+		\detail Threads record into their own profiler_buffer, which is created the first time the thread records a zone.
+		collect() drains the buffers, either on demand or periodically on a background thread. Each collected event is added
+		to running per-zone statistics and to a ring of the most recent events for trace export, so memory stays bounded
+		when the collector runs indefinitely.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class profiler {
+	public:
+		/*!
+			\brief Aggregated timings of all zones with the same name and category.
+		*/
+		struct zone_statistics {
+			std::string name;
+			std::string category;
+			uint64_t count;		//!< Number of times the zone was entered
+			double total;		//!< Total time in nanoseconds
+			double min;			//!< Shortest time in nanoseconds
+			double max;			//!< Longest time in nanoseconds
+
+			double mean() const throw() {
+				return count == 0 ? 0.0 : total / static_cast<double>(count);
+			}
+		};
+	private:
+		struct thread_registration;
+
+		/*!
+			\brief The per-thread state, trivially destructible so that it can still be read while the thread's other
+			thread_local objects are being destroyed.
+		*/
+		struct thread_slot {
+			profiler_buffer* buffer;
+			bool retired;			//!< Set once the thread's buffer has been handed back to the collector
+		};
+
+		static inline thread_slot& get_thread_slot() throw() {
+			static thread_local thread_slot SLOT = { nullptr, false };
+			return SLOT;
+		}
+
+		static profiler_buffer* register_thread();
+	public:
+		/*!
+			\brief Get the buffer of the calling thread, creating it if necessary.
+			\return The buffer, or nullptr if the thread is exiting and its buffer has already been retired.
+		*/
+		static inline profiler_buffer* get_thread_buffer() {
+			thread_slot& slot = get_thread_slot();
+			if(slot.buffer == nullptr && ! slot.retired) slot.buffer = register_thread();
+			return slot.buffer;
+		}
+
+		/*!
+			\brief Set the number of events in each thread buffer.
+			\detail Only affects threads that have not recorded a zone yet.
+		*/
+		static void set_buffer_capacity(const size_t aCapacity);
+
+		/*!
+			\brief Set the number of events kept for get_events and write_chrome_trace.
+			\detail If there are more events than this then the oldest are discarded. 0 keeps only the statistics.
+		*/
+		static void set_trace_capacity(const size_t aCapacity);
+
+		/*!
+			\brief Drain the events recorded by all threads into the statistics and the trace ring.
+			\return The number of events collected.
+		*/
+		static size_t collect();
+
+		/*!
+			\brief Call collect periodically on a background thread.
+			\param aPeriod The time between collections.
+			\return False if the collector is already running.
+		*/
+		static bool start_collector(const std::chrono::milliseconds aPeriod);
+
+		/*!
+			\brief Stop the background collector, then collect any remaining events.
+		*/
+		static void stop_collector();
+
+		/*!
+			\brief Discard all collected events and statistics.
+		*/
+		static void clear();
+
+		/*!
+			\brief Get the number of events that were dropped because a thread buffer was full.
+		*/
+		static uint64_t get_dropped();
+
+		/*!
+			\brief Get the number of collected events that were pushed out of the trace ring by newer events.
+			\detail These events are still included in get_statistics.
+		*/
+		static uint64_t get_overwritten();
+
+		/*!
+			\brief Get a copy of the most recent collected events, oldest first.
+			\param aThreadIDs If not nullptr then receives the ID of the thread that recorded each event.
+		*/
+		static std::vector<profiler_event> get_events(std::vector<uint32_t>* aThreadIDs = nullptr);
+
+		/*!
+			\brief Get the timings of every collected event, including those no longer in the trace ring, aggregated by zone.
+			\return The statistics of each zone, ordered by total time (highest first).
+		*/
+		static std::vector<zone_statistics> get_statistics();
+
+		/*!
+			\brief Write the events in the trace ring in the Chrome trace event format.
+			\detail The output can be opened with chrome://tracing or https://ui.perfetto.dev
+			\param aStream The stream to write to.
+		*/
+		static void write_chrome_trace(std::ostream& aStream);
+	};
+
+	/*!
+		\brief Records the time between its construction and destruction as a profiling zone.
+		\detail Usually created with the ASMITH_PROFILE_ZONE macros, which compile to nothing unless ASMITH_PROFILER_ENABLED
+		is defined.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class profiler_zone {
+	private:
+		profiler_event mEvent;
+
+		profiler_zone(const profiler_zone&) = delete;
+		profiler_zone& operator=(const profiler_zone&) = delete;
+	public:
+		inline profiler_zone(const char* const aName, const char* const aCategory, const char* const aArgName = nullptr, const int64_t aArgValue = 0) throw() {
+			mEvent.name = aName;
+			mEvent.category = aCategory;
+			mEvent.arg_name = aArgName;
+			mEvent.arg_value = aArgValue;
+			mEvent.begin = tsc_clock::now();
+		}
+
+		inline ~profiler_zone() throw() {
+			mEvent.end = tsc_clock::now();
+			profiler_buffer* const buffer = profiler::get_thread_buffer();
+			if(buffer != nullptr) buffer->push(mEvent);
+		}
+	};
+}
+
+#define ASMITH_PROFILE_CONCATENATE_IMPL(a, b) a##b
+#define ASMITH_PROFILE_CONCATENATE(a, b) ASMITH_PROFILE_CONCATENATE_IMPL(a, b)
+
+#ifdef ASMITH_PROFILER_ENABLED
+	#define ASMITH_PROFILE_ZONE(aName) asmith::profiler_zone ASMITH_PROFILE_CONCATENATE(asmith_profile_zone_, __LINE__)(aName, "")
+	#define ASMITH_PROFILE_ZONE_CATEGORY(aName, aCategory) asmith::profiler_zone ASMITH_PROFILE_CONCATENATE(asmith_profile_zone_, __LINE__)(aName, aCategory)
+	#define ASMITH_PROFILE_ZONE_ARG(aName, aCategory, aArgName, aArgValue) asmith::profiler_zone ASMITH_PROFILE_CONCATENATE(asmith_profile_zone_, __LINE__)(aName, aCategory, aArgName, static_cast<int64_t>(aArgValue))
+	#define ASMITH_PROFILE_FUNCTION() ASMITH_PROFILE_ZONE(__func__)
+#else
+	#define ASMITH_PROFILE_ZONE(aName)
+	#define ASMITH_PROFILE_ZONE_CATEGORY(aName, aCategory)
+	#define ASMITH_PROFILE_ZONE_ARG(aName, aCategory, aArgName, aArgValue)
+	#define ASMITH_PROFILE_FUNCTION()
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,416 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_QUANTILE_SKETCH_HPP
+#define ASMITH_UTILITIES_QUANTILE_SKETCH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace asmith {
+
+	/*!
+		\brief A mergeable sketch for estimating quantiles of a stream using a merging t-digest.
+		\detail Values are buffered and periodically merged into roughly compression / 2 centroids. Accuracy is
+		highest at the extreme quantiles (eg. p99, p999), where error is proportional to q * (1 - q).
+		Memory use depends only on the compression, not on the number of values added.
+		\tparam T The floating point type of the values.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T = double>
+	class quantile_sketch {
+	public:
+		/*!
+			\brief A cluster of values summarised by their mean.
+		*/
+		struct centroid {
+			T mean;			//!< The mean of the values in the cluster
+			double weight;	//!< The number of values in the cluster
+		};
+	private:
+		enum : uint32_t {
+			SERIAL_MAGIC = 0x54444731	//!< "TDG1"
+		};
+
+		std::vector<centroid> mCentroids;	//!< Merged centroids, ordered by mean
+		std::vector<centroid> mBuffer;		//!< Values that have not been merged yet
+		std::vector<centroid> mScratch;		//!< Used by compress to sort the buffer and centroids together
+		double mCompression;				//!< Controls the trade-off between size and accuracy
+		double mWeight;						//!< Total weight of mCentroids and mBuffer
+		T mMin;								//!< Smallest value added
+		T mMax;								//!< Largest value added
+
+		/*!
+			\brief Clamp a compression to the supported range, which bounds the memory used by the buffers.
+		*/
+		static double clamp_compression(const double aCompression) throw() {
+			if(! (aCompression >= 10.0)) return 10.0;
+			return aCompression > 100000.0 ? 100000.0 : aCompression;
+		}
+
+		static bool is_finite(const double aValue) throw() {
+			return aValue - aValue == 0.0;
+		}
+
+		/*!
+			\brief Check if a value read from a serialised sketch is finite and can be converted to T.
+		*/
+		static bool is_valid_value(const double aValue) throw() {
+			return is_finite(aValue) && std::abs(aValue) <= static_cast<double>(std::numeric_limits<T>::max());
+		}
+
+		double scale(const double aQ) const throw() {
+			return mCompression / (2.0 * 3.14159265358979323846) * std::asin(2.0 * aQ - 1.0);
+		}
+
+		double inverse_scale(const double aK) const throw() {
+			const double k = std::min(aK * (2.0 * 3.14159265358979323846) / mCompression, 3.14159265358979323846 / 2.0);
+			return (std::sin(k) + 1.0) / 2.0;
+		}
+
+		/*!
+			\brief Get the number of values that are buffered before they are merged into the centroids.
+		*/
+		size_t buffer_limit() const throw() {
+			return static_cast<size_t>(mCompression) * 10;
+		}
+
+		/*!
+			\brief Allocate the buffers up front so that adding values never grows them.
+		*/
+		void reserve_storage() {
+			const size_t centroids = std::max(static_cast<size_t>(mCompression) * 2, mCentroids.size());
+			mCentroids.reserve(centroids);
+			mBuffer.reserve(buffer_limit());
+			mScratch.reserve(buffer_limit() + centroids);
+		}
+
+		/*!
+			\brief Merge the buffered values into the centroids.
+		*/
+		void compress() {
+			if(mBuffer.empty()) return;
+			mScratch.clear();
+			mScratch.insert(mScratch.end(), mBuffer.begin(), mBuffer.end());
+			mScratch.insert(mScratch.end(), mCentroids.begin(), mCentroids.end());
+			std::sort(mScratch.begin(), mScratch.end(), [](const centroid& a, const centroid& b)->bool {
+				return a.mean < b.mean;
+			});
+
+			mCentroids.clear();
+			centroid current = mScratch[0];
+			double weight_so_far = 0.0;
+			double q_limit = inverse_scale(scale(0.0) + 1.0) * mWeight;
+			const size_t size = mScratch.size();
+			for(size_t i = 1; i < size; ++i) {
+				const centroid& next = mScratch[i];
+				if(weight_so_far + current.weight + next.weight <= q_limit) {
+					current.weight += next.weight;
+					current.mean += static_cast<T>((next.mean - current.mean) * (next.weight / current.weight));
+				}else {
+					weight_so_far += current.weight;
+					mCentroids.push_back(current);
+					q_limit = inverse_scale(scale(weight_so_far / mWeight) + 1.0) * mWeight;
+					current = next;
+				}
+			}
+			mCentroids.push_back(current);
+			mBuffer.clear();
+		}
+
+		void add_centroid(const centroid& aCentroid) {
+			if(mWeight == 0.0) {
+				mMin = aCentroid.mean;
+				mMax = aCentroid.mean;
+			}else {
+				mMin = std::min(mMin, aCentroid.mean);
+				mMax = std::max(mMax, aCentroid.mean);
+			}
+			mBuffer.push_back(aCentroid);
+			mWeight += aCentroid.weight;
+			if(mBuffer.size() >= buffer_limit()) compress();
+		}
+
+		static void write_64(uint8_t*& aPos, const uint64_t aValue) throw() {
+			for(int i = 0; i < 8; ++i) *(aPos++) = static_cast<uint8_t>(aValue >> (i * 8));
+		}
+
+		static uint64_t read_64(const uint8_t*& aPos) throw() {
+			uint64_t tmp = 0;
+			for(int i = 0; i < 8; ++i) tmp |= static_cast<uint64_t>(*(aPos++)) << (i * 8);
+			return tmp;
+		}
+
+		static void write_d(uint8_t*& aPos, const double aValue) throw() {
+			uint64_t tmp;
+			std::memcpy(&tmp, &aValue, sizeof(double));
+			write_64(aPos, tmp);
+		}
+
+		static double read_d(const uint8_t*& aPos) throw() {
+			const uint64_t tmp = read_64(aPos);
+			double value;
+			std::memcpy(&value, &tmp, sizeof(double));
+			return value;
+		}
+	public:
+		/*!
+			\brief Create a new sketch.
+			\param aCompression Higher values are more accurate but use more memory. The sketch holds roughly aCompression / 2 centroids.
+			Clamped to between 10 and 100000.
+		*/
+		explicit quantile_sketch(const double aCompression = 100.0) :
+			mCompression(clamp_compression(aCompression)),
+			mWeight(0.0),
+			mMin(static_cast<T>(0)),
+			mMax(static_cast<T>(0))
+		{
+			reserve_storage();
+		}
+
+		/*!
+			\brief Add a value to the sketch.
+			\param aValue The value to add.
+			\param aWeight The number of instances of aValue.
+		*/
+		void add(const T aValue, const double aWeight = 1.0) {
+			if(aWeight <= 0.0 || aValue != aValue) return;
+			add_centroid(centroid{aValue, aWeight});
+		}
+
+		/*!
+			\brief Combine another sketch into this one.
+			\param aOther The sketch to merge.
+		*/
+		void merge(const quantile_sketch& aOther) {
+			if(&aOther == this) {
+				// Adding centroids may compress and invalidate the vectors being read
+				const quantile_sketch copy(aOther);
+				merge(copy);
+				return;
+			}
+			for(const centroid& i : aOther.mCentroids) add_centroid(i);
+			for(const centroid& i : aOther.mBuffer) add_centroid(i);
+			if(aOther.mWeight > 0.0) {
+				mMin = std::min(mMin, aOther.mMin);
+				mMax = std::max(mMax, aOther.mMax);
+			}
+		}
+
+		/*!
+			\brief Estimate the value at a quantile.
+			\param aQ The quantile, between 0 and 1 (eg. 0.99 for p99).
+			\return The estimated value, or NaN if the sketch is empty.
+		*/
+		T quantile(const double aQ) {
+			compress();
+			if(mCentroids.empty()) return std::numeric_limits<T>::quiet_NaN();
+			if(aQ <= 0.0) return mMin;
+			if(aQ >= 1.0) return mMax;
+
+			const double index = aQ * mWeight;
+			const size_t size = mCentroids.size();
+
+			// Between the minimum and the centre of the first centroid
+			double centre = mCentroids[0].weight / 2.0;
+			if(index < centre) {
+				return static_cast<T>(mMin + (mCentroids[0].mean - mMin) * (index / centre));
+			}
+
+			// Between two centroid centres
+			for(size_t i = 1; i < size; ++i) {
+				const double next_centre = centre + (mCentroids[i - 1].weight + mCentroids[i].weight) / 2.0;
+				if(index < next_centre) {
+					const double t = (index - centre) / (next_centre - centre);
+					return static_cast<T>(mCentroids[i - 1].mean + (mCentroids[i].mean - mCentroids[i - 1].mean) * t);
+				}
+				centre = next_centre;
+			}
+
+			// Between the centre of the last centroid and the maximum
+			const double t = (index - centre) / (mWeight - centre);
+			return static_cast<T>(mCentroids[size - 1].mean + (mMax - mCentroids[size - 1].mean) * t);
+		}
+
+		/*!
+			\brief Estimate the fraction of values that are less than or equal to a value.
+			\param aValue The value to check.
+			\return The estimated quantile of aValue, or NaN if the sketch is empty.
+		*/
+		double cdf(const T aValue) {
+			compress();
+			if(mCentroids.empty()) return std::numeric_limits<double>::quiet_NaN();
+			if(aValue < mMin) return 0.0;
+			if(aValue >= mMax) return 1.0;
+
+			const size_t size = mCentroids.size();
+			double centre = mCentroids[0].weight / 2.0;
+			if(aValue < mCentroids[0].mean) {
+				const double range = static_cast<double>(mCentroids[0].mean - mMin);
+				return range <= 0.0 ? 0.0 : centre * (static_cast<double>(aValue - mMin) / range) / mWeight;
+			}
+
+			for(size_t i = 1; i < size; ++i) {
+				const double next_centre = centre + (mCentroids[i - 1].weight + mCentroids[i].weight) / 2.0;
+				if(aValue < mCentroids[i].mean) {
+					const double range = static_cast<double>(mCentroids[i].mean - mCentroids[i - 1].mean);
+					const double t = range <= 0.0 ? 0.0 : static_cast<double>(aValue - mCentroids[i - 1].mean) / range;
+					return (centre + (next_centre - centre) * t) / mWeight;
+				}
+				centre = next_centre;
+			}
+
+			const double range = static_cast<double>(mMax - mCentroids[size - 1].mean);
+			const double t = range <= 0.0 ? 1.0 : static_cast<double>(aValue - mCentroids[size - 1].mean) / range;
+			return (centre + (mWeight - centre) * t) / mWeight;
+		}
+
+		/*!
+			\brief Get the merged centroids.
+		*/
+		const std::vector<centroid>& centroids() {
+			compress();
+			return mCentroids;
+		}
+
+		/*!
+			\brief Remove all values from the sketch.
+		*/
+		void clear() throw() {
+			mCentroids.clear();
+			mBuffer.clear();
+			mWeight = 0.0;
+			mMin = static_cast<T>(0);
+			mMax = static_cast<T>(0);
+		}
+
+		double count() const throw() {
+			return mWeight;
+		}
+
+		double compression() const throw() {
+			return mCompression;
+		}
+
+		T min() const throw() {
+			return mMin;
+		}
+
+		T max() const throw() {
+			return mMax;
+		}
+
+		/*!
+			\brief Calculate the size of the serialised sketch.
+			\return The number of bytes that serialise will write.
+		*/
+		size_t serialised_size() {
+			compress();
+			return 4 + 8 * 5 + mCentroids.size() * 16;
+		}
+
+		/*!
+			\brief Write the sketch to a compact, platform independent, binary format.
+			\detail All fields are little-endian. Layout : magic (4 bytes), compression, weight, min, max (8 bytes each),
+			centroid count (8 bytes), then a mean and weight (8 bytes each) for each centroid.
+			\param aBuffer The buffer to write to, must be at least serialised_size() bytes.
+			\return The number of bytes written.
+		*/
+		size_t serialise(uint8_t* const aBuffer) {
+			compress();
+			uint8_t* pos = aBuffer;
+			for(int i = 0; i < 4; ++i) *(pos++) = static_cast<uint8_t>(SERIAL_MAGIC >> (i * 8));
+			write_d(pos, mCompression);
+			write_d(pos, mWeight);
+			write_d(pos, static_cast<double>(mMin));
+			write_d(pos, static_cast<double>(mMax));
+			write_64(pos, mCentroids.size());
+			for(const centroid& i : mCentroids) {
+				write_d(pos, static_cast<double>(i.mean));
+				write_d(pos, i.weight);
+			}
+			return static_cast<size_t>(pos - aBuffer);
+		}
+
+		/*!
+			\brief Write the sketch to a compact, platform independent, binary format.
+			\return The serialised sketch.
+			\see serialise(uint8_t*)
+		*/
+		std::vector<uint8_t> serialise() {
+			std::vector<uint8_t> tmp(serialised_size());
+			serialise(tmp.data());
+			return tmp;
+		}
+
+		/*!
+			\brief Replace the contents of the sketch with a serialised sketch.
+			\param aBuffer The serialised data.
+			\param aSize The size of aBuffer in bytes.
+			\return False if aBuffer does not contain a valid sketch, in which case this sketch is not modified.
+		*/
+		bool deserialise(const uint8_t* const aBuffer, const size_t aSize) {
+			if(aSize < 4 + 8 * 5) return false;
+			const uint8_t* pos = aBuffer;
+			uint32_t magic = 0;
+			for(int i = 0; i < 4; ++i) magic |= static_cast<uint32_t>(*(pos++)) << (i * 8);
+			if(magic != SERIAL_MAGIC) return false;
+
+			const double compression = read_d(pos);
+			const double weight = read_d(pos);
+			const double min = read_d(pos);
+			const double max = read_d(pos);
+			const uint64_t count = read_64(pos);
+			if(count > (aSize - (4 + 8 * 5)) / 16) return false;
+			if(! (compression >= 10.0 && compression <= 100000.0)) return false;
+			if(! is_finite(weight) || ! is_valid_value(min) || ! is_valid_value(max)) return false;
+			if(count == 0 ? weight != 0.0 || min != 0.0 || max != 0.0 : weight <= 0.0 || min > max) return false;
+
+			// Build the new state separately so that this sketch is not modified if it is invalid or allocation fails
+			quantile_sketch tmp(compression);
+			tmp.mWeight = weight;
+			tmp.mMin = static_cast<T>(min);
+			tmp.mMax = static_cast<T>(max);
+			tmp.mCentroids.reserve(static_cast<size_t>(count));
+			double total = 0.0;
+			for(uint64_t i = 0; i < count; ++i) {
+				const double value = read_d(pos);
+				const double centroid_weight = read_d(pos);
+				if(! is_valid_value(value) || ! is_finite(centroid_weight) || centroid_weight <= 0.0) return false;
+				const T mean = static_cast<T>(value);
+				if(i > 0 && mean < tmp.mCentroids.back().mean) return false;
+				tmp.mCentroids.push_back(centroid{mean, centroid_weight});
+				total += centroid_weight;
+			}
+			// The weights are summed in a different order than when they were added, so allow for rounding
+			if(std::abs(total - weight) > weight * 1e-9) return false;
+			tmp.reserve_storage();
+
+			mCentroids.swap(tmp.mCentroids);
+			mBuffer.swap(tmp.mBuffer);
+			mScratch.swap(tmp.mScratch);
+			mCompression = tmp.mCompression;
+			mWeight = tmp.mWeight;
+			mMin = tmp.mMin;
+			mMax = tmp.mMax;
+			return true;
+		}
+	};
+}
+#endif
\ No newline at end of file
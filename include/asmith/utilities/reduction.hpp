@@ -0,0 +1,426 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_REDUCTION_HPP
+#define ASMITH_UTILITIES_REDUCTION_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#if defined(__AVX__)
+	#define ASMITH_REDUCTION_AVX
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define ASMITH_REDUCTION_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace asmith {
+
+	/*!
+		\brief The count, mean and sum of squared deviations of a set of values.
+		\detail Two sets can be combined with merge (Chan et al.) without revisiting the values, which is
+		numerically stable and allows the values to be processed in independent blocks.
+		\tparam T The floating point type to accumulate in.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T = double>
+	struct moments {
+		uint64_t count;	//!< Number of values
+		T mean;			//!< Mean of the values
+		T m2;			//!< Sum of squared differences from the mean
+
+		moments() throw() :
+			count(0),
+			mean(static_cast<T>(0)),
+			m2(static_cast<T>(0))
+		{}
+
+		moments(const uint64_t aCount, const T aMean, const T aM2) throw() :
+			count(aCount),
+			mean(aMean),
+			m2(aM2)
+		{}
+
+		/*!
+			\brief Add a single value.
+		*/
+		void add(const T aValue) throw() {
+			++count;
+			const T delta = aValue - mean;
+			mean += delta / static_cast<T>(count);
+			m2 += delta * (aValue - mean);
+		}
+
+		/*!
+			\brief Combine with the moments of another set of values.
+		*/
+		void merge(const moments& aOther) throw() {
+			if(aOther.count == 0) return;
+			if(count == 0) {
+				*this = aOther;
+				return;
+			}
+			const T n_a = static_cast<T>(count);
+			const T n_b = static_cast<T>(aOther.count);
+			const T n = n_a + n_b;
+			const T delta = aOther.mean - mean;
+			mean += delta * (n_b / n);
+			m2 += aOther.m2 + delta * delta * (n_a * n_b / n);
+			count += aOther.count;
+		}
+
+		/*!
+			\brief Calculate the variance.
+			\param aSample True for the sample variance (n - 1), false for the population variance (n).
+		*/
+		T variance(const bool aSample) const throw() {
+			return m2 / static_cast<T>(aSample ? count - 1 : count);
+		}
+	};
+
+	namespace implementation {
+
+		/*!
+			\brief True if I is a pointer to a type with a vectorised reduction kernel.
+		*/
+		template<class I>
+		struct is_reducible {
+			typedef typename std::remove_cv<typename std::remove_pointer<I>::type>::type value_t;
+			enum : bool {
+				value = std::is_pointer<I>::value && (
+					std::is_same<value_t, float>::value ||
+					std::is_same<value_t, double>::value ||
+					std::is_same<value_t, int32_t>::value ||
+					std::is_same<value_t, int64_t>::value
+				)
+			};
+		};
+
+		enum : size_t {
+			MOMENTS_BLOCK_SIZE = 1024	//!< Number of values summed around a common shift before merging
+		};
+
+		// Sums
+		// Floating point values use several independent accumulators so that the adds can be pipelined and
+		// vectorised, floats are accumulated as doubles. Integers are accumulated in int64_t, which compilers
+		// vectorise without help.
+
+		inline double sum(const double* const aValues, const size_t aSize) throw() {
+			size_t i = 0;
+			double tmp = 0.0;
+#if defined(ASMITH_REDUCTION_AVX)
+			__m256d acc0 = _mm256_setzero_pd();
+			__m256d acc1 = _mm256_setzero_pd();
+			__m256d acc2 = _mm256_setzero_pd();
+			__m256d acc3 = _mm256_setzero_pd();
+			for(const size_t end = aSize - aSize % 16; i < end; i += 16) {
+				acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(aValues + i));
+				acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(aValues + i + 4));
+				acc2 = _mm256_add_pd(acc2, _mm256_loadu_pd(aValues + i + 8));
+				acc3 = _mm256_add_pd(acc3, _mm256_loadu_pd(aValues + i + 12));
+			}
+			acc0 = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+			double lanes[4];
+			_mm256_storeu_pd(lanes, acc0);
+			tmp = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(ASMITH_REDUCTION_SSE2)
+			__m128d acc0 = _mm_setzero_pd();
+			__m128d acc1 = _mm_setzero_pd();
+			__m128d acc2 = _mm_setzero_pd();
+			__m128d acc3 = _mm_setzero_pd();
+			for(const size_t end = aSize - aSize % 8; i < end; i += 8) {
+				acc0 = _mm_add_pd(acc0, _mm_loadu_pd(aValues + i));
+				acc1 = _mm_add_pd(acc1, _mm_loadu_pd(aValues + i + 2));
+				acc2 = _mm_add_pd(acc2, _mm_loadu_pd(aValues + i + 4));
+				acc3 = _mm_add_pd(acc3, _mm_loadu_pd(aValues + i + 6));
+			}
+			acc0 = _mm_add_pd(_mm_add_pd(acc0, acc1), _mm_add_pd(acc2, acc3));
+			double lanes[2];
+			_mm_storeu_pd(lanes, acc0);
+			tmp = lanes[0] + lanes[1];
+#else
+			double acc[4] = { 0.0, 0.0, 0.0, 0.0 };
+			for(const size_t end = aSize - aSize % 4; i < end; i += 4) {
+				acc[0] += aValues[i];
+				acc[1] += aValues[i + 1];
+				acc[2] += aValues[i + 2];
+				acc[3] += aValues[i + 3];
+			}
+			tmp = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+			for(; i < aSize; ++i) tmp += aValues[i];
+			return tmp;
+		}
+
+		inline double sum(const float* const aValues, const size_t aSize) throw() {
+			size_t i = 0;
+			double tmp = 0.0;
+#if defined(ASMITH_REDUCTION_AVX)
+			__m256d acc0 = _mm256_setzero_pd();
+			__m256d acc1 = _mm256_setzero_pd();
+			__m256d acc2 = _mm256_setzero_pd();
+			__m256d acc3 = _mm256_setzero_pd();
+			for(const size_t end = aSize - aSize % 16; i < end; i += 16) {
+				acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm_loadu_ps(aValues + i)));
+				acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm_loadu_ps(aValues + i + 4)));
+				acc2 = _mm256_add_pd(acc2, _mm256_cvtps_pd(_mm_loadu_ps(aValues + i + 8)));
+				acc3 = _mm256_add_pd(acc3, _mm256_cvtps_pd(_mm_loadu_ps(aValues + i + 12)));
+			}
+			acc0 = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+			double lanes[4];
+			_mm256_storeu_pd(lanes, acc0);
+			tmp = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(ASMITH_REDUCTION_SSE2)
+			__m128d acc0 = _mm_setzero_pd();
+			__m128d acc1 = _mm_setzero_pd();
+			__m128d acc2 = _mm_setzero_pd();
+			__m128d acc3 = _mm_setzero_pd();
+			for(const size_t end = aSize - aSize % 8; i < end; i += 8) {
+				const __m128 a = _mm_loadu_ps(aValues + i);
+				const __m128 b = _mm_loadu_ps(aValues + i + 4);
+				acc0 = _mm_add_pd(acc0, _mm_cvtps_pd(a));
+				acc1 = _mm_add_pd(acc1, _mm_cvtps_pd(_mm_movehl_ps(a, a)));
+				acc2 = _mm_add_pd(acc2, _mm_cvtps_pd(b));
+				acc3 = _mm_add_pd(acc3, _mm_cvtps_pd(_mm_movehl_ps(b, b)));
+			}
+			acc0 = _mm_add_pd(_mm_add_pd(acc0, acc1), _mm_add_pd(acc2, acc3));
+			double lanes[2];
+			_mm_storeu_pd(lanes, acc0);
+			tmp = lanes[0] + lanes[1];
+#else
+			double acc[4] = { 0.0, 0.0, 0.0, 0.0 };
+			for(const size_t end = aSize - aSize % 4; i < end; i += 4) {
+				acc[0] += aValues[i];
+				acc[1] += aValues[i + 1];
+				acc[2] += aValues[i + 2];
+				acc[3] += aValues[i + 3];
+			}
+			tmp = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+			for(; i < aSize; ++i) tmp += aValues[i];
+			return tmp;
+		}
+
+		inline int64_t sum(const int32_t* const aValues, const size_t aSize) throw() {
+			int64_t tmp = 0;
+			for(size_t i = 0; i < aSize; ++i) tmp += aValues[i];
+			return tmp;
+		}
+
+		inline int64_t sum(const int64_t* const aValues, const size_t aSize) throw() {
+			// Accumulate as unsigned so that overflow wraps the same way as a naive loop, without undefined behaviour
+			uint64_t tmp = 0;
+			for(size_t i = 0; i < aSize; ++i) tmp += static_cast<uint64_t>(aValues[i]);
+			return static_cast<int64_t>(tmp);
+		}
+
+		// Shifted sums
+		// Calculate the sum and sum of squares of (x - aShift) in a single pass. Choosing a shift close to the mean
+		// avoids the cancellation that makes the textbook one-pass variance formula inaccurate.
+
+		template<class X>
+		inline void shifted_sums(const X* const aValues, const size_t aSize, const double aShift, double& aSum, double& aSumSquares) throw() {
+			double s[4] = { 0.0, 0.0, 0.0, 0.0 };
+			double q[4] = { 0.0, 0.0, 0.0, 0.0 };
+			size_t i = 0;
+			for(const size_t end = aSize - aSize % 4; i < end; i += 4) {
+				for(size_t j = 0; j < 4; ++j) {
+					const double d = static_cast<double>(aValues[i + j]) - aShift;
+					s[j] += d;
+					q[j] += d * d;
+				}
+			}
+			for(; i < aSize; ++i) {
+				const double d = static_cast<double>(aValues[i]) - aShift;
+				s[0] += d;
+				q[0] += d * d;
+			}
+			aSum = (s[0] + s[1]) + (s[2] + s[3]);
+			aSumSquares = (q[0] + q[1]) + (q[2] + q[3]);
+		}
+
+#if defined(ASMITH_REDUCTION_AVX)
+		template<>
+		inline void shifted_sums<double>(const double* const aValues, const size_t aSize, const double aShift, double& aSum, double& aSumSquares) throw() {
+			const __m256d shift = _mm256_set1_pd(aShift);
+			__m256d s0 = _mm256_setzero_pd();
+			__m256d s1 = _mm256_setzero_pd();
+			__m256d q0 = _mm256_setzero_pd();
+			__m256d q1 = _mm256_setzero_pd();
+			size_t i = 0;
+			for(const size_t end = aSize - aSize % 8; i < end; i += 8) {
+				const __m256d a = _mm256_sub_pd(_mm256_loadu_pd(aValues + i), shift);
+				const __m256d b = _mm256_sub_pd(_mm256_loadu_pd(aValues + i + 4), shift);
+				s0 = _mm256_add_pd(s0, a);
+				s1 = _mm256_add_pd(s1, b);
+				q0 = _mm256_add_pd(q0, _mm256_mul_pd(a, a));
+				q1 = _mm256_add_pd(q1, _mm256_mul_pd(b, b));
+			}
+			double s[4];
+			double q[4];
+			_mm256_storeu_pd(s, _mm256_add_pd(s0, s1));
+			_mm256_storeu_pd(q, _mm256_add_pd(q0, q1));
+			for(; i < aSize; ++i) {
+				const double d = aValues[i] - aShift;
+				s[0] += d;
+				q[0] += d * d;
+			}
+			aSum = (s[0] + s[1]) + (s[2] + s[3]);
+			aSumSquares = (q[0] + q[1]) + (q[2] + q[3]);
+		}
+
+		template<>
+		inline void shifted_sums<float>(const float* const aValues, const size_t aSize, const double aShift, double& aSum, double& aSumSquares) throw() {
+			const __m256d shift = _mm256_set1_pd(aShift);
+			__m256d s0 = _mm256_setzero_pd();
+			__m256d s1 = _mm256_setzero_pd();
+			__m256d q0 = _mm256_setzero_pd();
+			__m256d q1 = _mm256_setzero_pd();
+			size_t i = 0;
+			for(const size_t end = aSize - aSize % 8; i < end; i += 8) {
+				const __m256d a = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(aValues + i)), shift);
+				const __m256d b = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(aValues + i + 4)), shift);
+				s0 = _mm256_add_pd(s0, a);
+				s1 = _mm256_add_pd(s1, b);
+				q0 = _mm256_add_pd(q0, _mm256_mul_pd(a, a));
+				q1 = _mm256_add_pd(q1, _mm256_mul_pd(b, b));
+			}
+			double s[4];
+			double q[4];
+			_mm256_storeu_pd(s, _mm256_add_pd(s0, s1));
+			_mm256_storeu_pd(q, _mm256_add_pd(q0, q1));
+			for(; i < aSize; ++i) {
+				const double d = static_cast<double>(aValues[i]) - aShift;
+				s[0] += d;
+				q[0] += d * d;
+			}
+			aSum = (s[0] + s[1]) + (s[2] + s[3]);
+			aSumSquares = (q[0] + q[1]) + (q[2] + q[3]);
+		}
+#elif defined(ASMITH_REDUCTION_SSE2)
+		template<>
+		inline void shifted_sums<double>(const double* const aValues, const size_t aSize, const double aShift, double& aSum, double& aSumSquares) throw() {
+			const __m128d shift = _mm_set1_pd(aShift);
+			__m128d s0 = _mm_setzero_pd();
+			__m128d s1 = _mm_setzero_pd();
+			__m128d q0 = _mm_setzero_pd();
+			__m128d q1 = _mm_setzero_pd();
+			size_t i = 0;
+			for(const size_t end = aSize - aSize % 4; i < end; i += 4) {
+				const __m128d a = _mm_sub_pd(_mm_loadu_pd(aValues + i), shift);
+				const __m128d b = _mm_sub_pd(_mm_loadu_pd(aValues + i + 2), shift);
+				s0 = _mm_add_pd(s0, a);
+				s1 = _mm_add_pd(s1, b);
+				q0 = _mm_add_pd(q0, _mm_mul_pd(a, a));
+				q1 = _mm_add_pd(q1, _mm_mul_pd(b, b));
+			}
+			double s[2];
+			double q[2];
+			_mm_storeu_pd(s, _mm_add_pd(s0, s1));
+			_mm_storeu_pd(q, _mm_add_pd(q0, q1));
+			for(; i < aSize; ++i) {
+				const double d = aValues[i] - aShift;
+				s[0] += d;
+				q[0] += d * d;
+			}
+			aSum = s[0] + s[1];
+			aSumSquares = q[0] + q[1];
+		}
+
+		template<>
+		inline void shifted_sums<float>(const float* const aValues, const size_t aSize, const double aShift, double& aSum, double& aSumSquares) throw() {
+			const __m128d shift = _mm_set1_pd(aShift);
+			__m128d s0 = _mm_setzero_pd();
+			__m128d s1 = _mm_setzero_pd();
+			__m128d q0 = _mm_setzero_pd();
+			__m128d q1 = _mm_setzero_pd();
+			size_t i = 0;
+			for(const size_t end = aSize - aSize % 4; i < end; i += 4) {
+				const __m128 v = _mm_loadu_ps(aValues + i);
+				const __m128d a = _mm_sub_pd(_mm_cvtps_pd(v), shift);
+				const __m128d b = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(v, v)), shift);
+				s0 = _mm_add_pd(s0, a);
+				s1 = _mm_add_pd(s1, b);
+				q0 = _mm_add_pd(q0, _mm_mul_pd(a, a));
+				q1 = _mm_add_pd(q1, _mm_mul_pd(b, b));
+			}
+			double s[2];
+			double q[2];
+			_mm_storeu_pd(s, _mm_add_pd(s0, s1));
+			_mm_storeu_pd(q, _mm_add_pd(q0, q1));
+			for(; i < aSize; ++i) {
+				const double d = static_cast<double>(aValues[i]) - aShift;
+				s[0] += d;
+				q[0] += d * d;
+			}
+			aSum = s[0] + s[1];
+			aSumSquares = q[0] + q[1];
+		}
+#endif
+
+		/*!
+			\brief Calculate the moments of a single block of values around the first value.
+		*/
+		template<class I>
+		moments<double> block_moments(const I aBegin, const size_t aSize, std::true_type) throw() {
+			const double shift = static_cast<double>(aBegin[0]);
+			double s;
+			double q;
+			shifted_sums(aBegin, aSize, shift, s, q);
+			const double n = static_cast<double>(aSize);
+			const double m2 = q - s * s / n;
+			return moments<double>(aSize, shift + s / n, m2 < 0.0 ? 0.0 : m2);
+		}
+
+		template<class I>
+		moments<double> block_moments(const I aBegin, const size_t aSize, std::false_type) {
+			const double shift = static_cast<double>(aBegin[0]);
+			double s[2] = { 0.0, 0.0 };
+			double q[2] = { 0.0, 0.0 };
+			I i = aBegin;
+			for(size_t j = 0; j < aSize; ++j, ++i) {
+				const double d = static_cast<double>(*i) - shift;
+				s[j & 1] += d;
+				q[j & 1] += d * d;
+			}
+			const double n = static_cast<double>(aSize);
+			const double sum = s[0] + s[1];
+			const double m2 = (q[0] + q[1]) - sum * sum / n;
+			return moments<double>(aSize, shift + sum / n, m2 < 0.0 ? 0.0 : m2);
+		}
+
+		/*!
+			\brief Calculate the moments of a range in a single pass.
+			\detail The range is split into blocks of MOMENTS_BLOCK_SIZE, each block is summed around its first value and the
+			blocks are combined with moments::merge in a balanced binary tree (pairwise), so rounding error grows with
+			O(log n) rather than O(n). The tree only depends on aSize, so the result is reproducible.
+			\param aBegin The first element, must be a random access iterator.
+			\param aSize The number of elements in the range.
+		*/
+		template<class I>
+		moments<double> compute_moments(const I aBegin, const size_t aSize) {
+			if(aSize == 0) return moments<double>();
+			if(aSize <= MOMENTS_BLOCK_SIZE) return block_moments(aBegin, aSize, std::integral_constant<bool, is_reducible<I>::value>());
+			const size_t blocks = (aSize + MOMENTS_BLOCK_SIZE - 1) / MOMENTS_BLOCK_SIZE;
+			const size_t half = (blocks / 2) * MOMENTS_BLOCK_SIZE;
+			moments<double> tmp = compute_moments(aBegin, half);
+			tmp.merge(compute_moments(aBegin + half, aSize - half));
+			return tmp;
+		}
+	}
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,130 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_RING_BUFFER_HPP
+#define ASMITH_UTILITIES_RING_BUFFER_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace asmith {
+
+	/*!
+		\brief A fixed capacity double-ended queue.
+		\detail All storage is allocated by the constructor, no operation allocates or frees memory afterwards.
+		\tparam T The type of element to store, must be default constructible and copyable.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T>
+	class ring_buffer {
+	private:
+		std::vector<T> mData;	//!< Element storage
+		size_t mHead;			//!< Index of the first element
+		size_t mSize;			//!< Number of elements stored
+
+		size_t wrap(const size_t aIndex) const throw() {
+			return aIndex >= mData.size() ? aIndex - mData.size() : aIndex;
+		}
+	public:
+		/*!
+			\brief Create a new ring buffer.
+			\param aCapacity The maximum number of elements, must be greater than 0.
+		*/
+		explicit ring_buffer(const size_t aCapacity) :
+			mData(aCapacity == 0 ? 1 : aCapacity),
+			mHead(0),
+			mSize(0)
+		{}
+
+		/*!
+			\brief Add an element to the back of the buffer.
+			\detail If the buffer is full then the front element is overwritten.
+			\param aValue The element to add.
+		*/
+		void push_back(const T& aValue) {
+			if(mSize == mData.size()) {
+				mData[mHead] = aValue;
+				mHead = wrap(mHead + 1);
+			}else {
+				mData[wrap(mHead + mSize)] = aValue;
+				++mSize;
+			}
+		}
+
+		/*!
+			\brief Remove the front element, the buffer must not be empty.
+		*/
+		void pop_front() throw() {
+			mHead = wrap(mHead + 1);
+			--mSize;
+		}
+
+		/*!
+			\brief Remove the back element, the buffer must not be empty.
+		*/
+		void pop_back() throw() {
+			--mSize;
+		}
+
+		T& front() throw() {
+			return mData[mHead];
+		}
+
+		const T& front() const throw() {
+			return mData[mHead];
+		}
+
+		T& back() throw() {
+			return mData[wrap(mHead + mSize - 1)];
+		}
+
+		const T& back() const throw() {
+			return mData[wrap(mHead + mSize - 1)];
+		}
+
+		/*!
+			\brief Access an element, where 0 is the front of the buffer.
+		*/
+		T& operator[](const size_t aIndex) throw() {
+			return mData[wrap(mHead + aIndex)];
+		}
+
+		const T& operator[](const size_t aIndex) const throw() {
+			return mData[wrap(mHead + aIndex)];
+		}
+
+		void clear() throw() {
+			mHead = 0;
+			mSize = 0;
+		}
+
+		size_t size() const throw() {
+			return mSize;
+		}
+
+		size_t capacity() const throw() {
+			return mData.size();
+		}
+
+		bool empty() const throw() {
+			return mSize == 0;
+		}
+
+		bool full() const throw() {
+			return mSize == mData.size();
+		}
+	};
+}
+#endif
\ No newline at end of file
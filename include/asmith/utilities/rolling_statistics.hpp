@@ -0,0 +1,369 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_ROLLING_STATISTICS_HPP
+#define ASMITH_UTILITIES_ROLLING_STATISTICS_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+#include <functional>
+#include "ring_buffer.hpp"
+
+namespace asmith {
+
+	/*!
+		\brief Mean and variance of the last N values added.
+		\detail Each update is O(1), the value leaving the window is replaced using a Welford style update.
+		\tparam T The floating point type of the values.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T = double>
+	class rolling_moments {
+	private:
+		ring_buffer<T> mValues;	//!< The values in the window
+		T mMean;				//!< Mean of the values in the window
+		T mM2;					//!< Sum of squared differences from the mean
+	public:
+		/*!
+			\brief Create a new window.
+			\param aSize The number of values in the window.
+		*/
+		explicit rolling_moments(const size_t aSize) :
+			mValues(aSize),
+			mMean(static_cast<T>(0)),
+			mM2(static_cast<T>(0))
+		{}
+
+		/*!
+			\brief Add a value, removing the oldest value if the window is full.
+			\param aValue The value to add.
+		*/
+		void add(const T aValue) throw() {
+			if(mValues.full()) {
+				const T old = mValues.front();
+				const T old_mean = mMean;
+				mMean += (aValue - old) / static_cast<T>(mValues.size());
+				mM2 += (aValue - old) * (aValue - mMean + old - old_mean);
+				if(mM2 < static_cast<T>(0)) mM2 = static_cast<T>(0);
+			}else {
+				const T delta = aValue - mMean;
+				mMean += delta / static_cast<T>(mValues.size() + 1);
+				mM2 += delta * (aValue - mMean);
+			}
+			mValues.push_back(aValue);
+		}
+
+		/*!
+			\brief Remove all values.
+		*/
+		void clear() throw() {
+			mValues.clear();
+			mMean = static_cast<T>(0);
+			mM2 = static_cast<T>(0);
+		}
+
+		T mean() const throw() {
+			return mMean;
+		}
+
+		/*!
+			\brief Calculate the variance of the window.
+			\param aSample True for the sample variance (n - 1), false for the population variance (n).
+		*/
+		T variance(const bool aSample = false) const throw() {
+			const size_t n = aSample ? mValues.size() - 1 : mValues.size();
+			return n == 0 ? static_cast<T>(0) : mM2 / static_cast<T>(n);
+		}
+
+		T standard_deviation(const bool aSample = false) const throw() {
+			return std::sqrt(variance(aSample));
+		}
+
+		size_t size() const throw() {
+			return mValues.size();
+		}
+
+		size_t capacity() const throw() {
+			return mValues.capacity();
+		}
+	};
+
+	/*!
+		\brief Mean and variance of the values added within a time window.
+		\detail Values that are older than the window are removed when a value is added or expire is called,
+		each removal is O(1). At most capacity() values are kept, if more values arrive within the window then
+		the oldest values are removed early.
+		\tparam T The floating point type of the values.
+		\tparam CLOCK The clock used to timestamp values.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T = double, class CLOCK = std::chrono::steady_clock>
+	class timed_rolling_moments {
+	public:
+		typedef typename CLOCK::time_point time_point;
+		typedef typename CLOCK::duration duration;
+	private:
+		struct sample {
+			time_point time;
+			T value;
+		};
+
+		ring_buffer<sample> mSamples;	//!< The values in the window, oldest first
+		duration mWindow;				//!< Length of the window
+		T mMean;						//!< Mean of the values in the window
+		T mM2;							//!< Sum of squared differences from the mean
+
+		void remove_oldest() throw() {
+			const T value = mSamples.front().value;
+			mSamples.pop_front();
+			if(mSamples.empty()) {
+				mMean = static_cast<T>(0);
+				mM2 = static_cast<T>(0);
+				return;
+			}
+			const T delta = value - mMean;
+			mMean -= delta / static_cast<T>(mSamples.size());
+			mM2 -= delta * (value - mMean);
+			if(mM2 < static_cast<T>(0)) mM2 = static_cast<T>(0);
+		}
+	public:
+		/*!
+			\brief Create a new window.
+			\param aWindow The length of the window.
+			\param aCapacity The maximum number of values that can be held in the window.
+		*/
+		timed_rolling_moments(const duration aWindow, const size_t aCapacity) :
+			mSamples(aCapacity),
+			mWindow(aWindow),
+			mMean(static_cast<T>(0)),
+			mM2(static_cast<T>(0))
+		{}
+
+		/*!
+			\brief Remove values that are older than the window.
+			\param aNow The current time.
+		*/
+		void expire(const time_point aNow) throw() {
+			while(! mSamples.empty() && aNow - mSamples.front().time > mWindow) remove_oldest();
+		}
+
+		/*!
+			\brief Add a value.
+			\param aValue The value to add.
+			\param aTime The time of the value, must not be earlier than the previous value.
+		*/
+		void add(const T aValue, const time_point aTime = CLOCK::now()) throw() {
+			expire(aTime);
+			if(mSamples.full()) remove_oldest();
+			const T delta = aValue - mMean;
+			mMean += delta / static_cast<T>(mSamples.size() + 1);
+			mM2 += delta * (aValue - mMean);
+			mSamples.push_back(sample{aTime, aValue});
+		}
+
+		/*!
+			\brief Remove all values.
+		*/
+		void clear() throw() {
+			mSamples.clear();
+			mMean = static_cast<T>(0);
+			mM2 = static_cast<T>(0);
+		}
+
+		T mean() const throw() {
+			return mMean;
+		}
+
+		/*!
+			\brief Calculate the variance of the window.
+			\param aSample True for the sample variance (n - 1), false for the population variance (n).
+		*/
+		T variance(const bool aSample = false) const throw() {
+			const size_t n = aSample ? mSamples.size() - 1 : mSamples.size();
+			return n == 0 ? static_cast<T>(0) : mM2 / static_cast<T>(n);
+		}
+
+		T standard_deviation(const bool aSample = false) const throw() {
+			return std::sqrt(variance(aSample));
+		}
+
+		size_t size() const throw() {
+			return mSamples.size();
+		}
+
+		duration window() const throw() {
+			return mWindow;
+		}
+	};
+
+	/*!
+		\brief Exponentially weighted moving average and variance.
+		\detail The weight of a value halves after every half-life, either measured in samples (add(T)) or in
+		elapsed time (add(T, double)). Uses the incremental update from Finch, "Incremental calculation of
+		weighted mean and variance" (2009). Uses O(1) memory.
+		\tparam T The floating point type of the values.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T = double>
+	class ewma {
+	private:
+		T mHalfLife;	//!< The half-life, in samples or in the unit of elapsed time
+		T mAlpha;		//!< The weight of each new sample when using add(T)
+		T mMean;		//!< The weighted mean
+		T mVariance;	//!< The weighted variance
+		uint64_t mCount;
+
+		void update(const T aValue, const T aAlpha) throw() {
+			if(mCount++ == 0) {
+				mMean = aValue;
+				mVariance = static_cast<T>(0);
+				return;
+			}
+			const T delta = aValue - mMean;
+			const T increment = aAlpha * delta;
+			mMean += increment;
+			mVariance = (static_cast<T>(1) - aAlpha) * (mVariance + delta * increment);
+		}
+	public:
+		/*!
+			\brief Create a new average.
+			\param aHalfLife The number of samples (or elapsed time) after which the weight of a value halves.
+		*/
+		explicit ewma(const T aHalfLife) throw() :
+			mHalfLife(aHalfLife),
+			mAlpha(static_cast<T>(1) - std::exp2(static_cast<T>(-1) / aHalfLife)),
+			mMean(static_cast<T>(0)),
+			mVariance(static_cast<T>(0)),
+			mCount(0)
+		{}
+
+		/*!
+			\brief Add a value, the weight of previous values decays by one sample.
+		*/
+		void add(const T aValue) throw() {
+			update(aValue, mAlpha);
+		}
+
+		/*!
+			\brief Add a value, the weight of previous values decays by the time since the previous value.
+			\param aValue The value to add.
+			\param aElapsed The time since the previous value, in the same unit as the half-life.
+		*/
+		void add(const T aValue, const T aElapsed) throw() {
+			update(aValue, static_cast<T>(1) - std::exp2(-aElapsed / mHalfLife));
+		}
+
+		void clear() throw() {
+			mMean = static_cast<T>(0);
+			mVariance = static_cast<T>(0);
+			mCount = 0;
+		}
+
+		T mean() const throw() {
+			return mMean;
+		}
+
+		T variance() const throw() {
+			return mVariance;
+		}
+
+		T standard_deviation() const throw() {
+			return std::sqrt(mVariance);
+		}
+
+		T half_life() const throw() {
+			return mHalfLife;
+		}
+
+		uint64_t count() const throw() {
+			return mCount;
+		}
+	};
+
+	/*!
+		\brief The minimum or maximum of the last N values added.
+		\detail Keeps a monotonic queue of candidate values, each value is pushed and popped at most once so
+		updates are amortised O(1) and queries are O(1).
+		\tparam T The type of the values.
+		\tparam COMPARE std::less<T> for a sliding minimum, std::greater<T> for a sliding maximum.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T, class COMPARE>
+	class sliding_extremum {
+	private:
+		struct candidate {
+			uint64_t index;
+			T value;
+		};
+
+		ring_buffer<candidate> mCandidates;	//!< Values that could still become the extremum, best first
+		uint64_t mIndex;					//!< Number of values added
+		size_t mSize;						//!< Number of values in the window
+		COMPARE mCompare;
+	public:
+		/*!
+			\brief Create a new window.
+			\param aSize The number of values in the window.
+		*/
+		explicit sliding_extremum(const size_t aSize) :
+			mCandidates(aSize),
+			mIndex(0),
+			mSize(aSize == 0 ? 1 : aSize)
+		{}
+
+		/*!
+			\brief Add a value, removing the oldest value if the window is full.
+		*/
+		void add(const T& aValue) {
+			while(! mCandidates.empty() && ! mCompare(mCandidates.back().value, aValue)) mCandidates.pop_back();
+			if(! mCandidates.empty() && mCandidates.front().index + mSize <= mIndex) mCandidates.pop_front();
+			mCandidates.push_back(candidate{mIndex++, aValue});
+		}
+
+		/*!
+			\brief Get the extremum of the window, the window must not be empty.
+		*/
+		const T& get() const throw() {
+			return mCandidates.front().value;
+		}
+
+		void clear() throw() {
+			mCandidates.clear();
+			mIndex = 0;
+		}
+
+		bool empty() const throw() {
+			return mIndex == 0;
+		}
+
+		size_t size() const throw() {
+			return mIndex < mSize ? static_cast<size_t>(mIndex) : mSize;
+		}
+	};
+
+	template<class T>
+	using sliding_min = sliding_extremum<T, std::less<T>>;
+
+	template<class T>
+	using sliding_max = sliding_extremum<T, std::greater<T>>;
+}
+#endif
\ No newline at end of file
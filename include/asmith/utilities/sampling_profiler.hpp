@@ -0,0 +1,108 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_SAMPLING_PROFILER_HPP
+#define ASMITH_UTILITIES_SAMPLING_PROFILER_HPP
+
+#include <cstdint>
+#include <ostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define ASMITH_SAMPLING_PROFILER_AVAILABLE
+#endif
+
+namespace asmith {
+
+	/*!
+		\brief Controls how the sampling profiler collects samples.
+	*/
+	struct sampling_profiler_options {
+		uint32_t frequency;		//!< Samples per second of CPU time used by the process, the kernel may limit this to its timer tick rate
+		uint32_t max_depth;		//!< The maximum number of frames recorded per sample, 1 records only the program counter
+		uint32_t capacity;		//!< The maximum number of samples, later samples are dropped
+
+		sampling_profiler_options() :
+			frequency(997),
+			max_depth(64),
+			capacity(1 << 16)
+		{}
+	};
+
+	/*!
+		\brief A statistical CPU profiler that periodically samples the program counter and call stack.
+		\detail A SIGPROF timer (setitimer with ITIMER_PROF) interrupts whichever thread is using CPU time. The signal
+		handler reads the program counter from the interrupted context and, if max_depth is greater than 1, follows
+		the frame pointer chain, then writes the addresses to a preallocated buffer with a single atomic increment.
+		The handler does not allocate or take locks.
+		\n Addresses are only converted to names when a report is written, using dladdr. Call stacks are only complete
+		for code compiled with frame pointers (-fno-omit-frame-pointer) and names are only available for exported
+		symbols (link with -rdynamic to include the executable's own functions), other frames are written as the
+		name of their module.
+		\n The frame pointer chain is only followed within the stack of the interrupted thread, so code that uses the
+		frame pointer register for other purposes cannot crash the handler. The stack bounds are captured by
+		register_thread, which start calls for the calling thread. Samples from threads that have not registered only
+		contain the program counter.
+		\n Only available on POSIX systems, start returns false on other platforms.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class sampling_profiler {
+	public:
+		/*!
+			\brief Start sampling.
+			\detail Any samples from a previous run are discarded. Replaces the process's SIGPROF handler until stop is called.
+			\return False if the profiler is already running or is not supported on this platform.
+		*/
+		static bool start(const sampling_profiler_options& aOptions = sampling_profiler_options());
+
+		/*!
+			\brief Stop sampling, the collected samples are kept until the next call to start or clear.
+			\detail Waits for signal handlers that are still running on other threads, so the buffer is not in use once this
+			returns.
+		*/
+		static void stop();
+
+		static bool is_running();
+
+		/*!
+			\brief Record the stack bounds of the calling thread so that its samples include the call stack.
+			\detail Must be called on each thread that should have full call stacks, other than the one that calls start.
+			\return False if the bounds could not be determined.
+		*/
+		static bool register_thread();
+
+		/*!
+			\brief Discard all collected samples, the profiler must be stopped.
+		*/
+		static void clear();
+
+		/*!
+			\brief Get the number of samples that have been recorded.
+		*/
+		static uint64_t get_sample_count();
+
+		/*!
+			\brief Get the number of samples that were discarded because the buffer was full.
+		*/
+		static uint64_t get_dropped();
+
+		/*!
+			\brief Write the collected samples in the folded stack format used by flamegraph.pl and speedscope.
+			\detail Each line contains the frames of a distinct call stack, outermost first and separated by ';',
+			followed by the number of samples with that stack. The profiler must be stopped.
+		*/
+		static void write_folded(std::ostream& aStream);
+	};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,265 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_SLOT_MAP_HPP
+#define ASMITH_UTILITIES_SLOT_MAP_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "id_generator_bitmap.hpp"
+
+namespace asmith {
+
+	/*!
+		\brief A container that addresses values with generational handles.
+		\detail A handle packs a slot index (the low half of the bits) and the generation of the slot (the high half).
+		Erasing a value increments the generation of its slot, so handles to erased values are detected instead of
+		silently referring to a value that later reuses the slot. Slot indices are allocated with id_generator_bitmap,
+		so the lowest free slot is always reused first.
+		\n Values are stored contiguously and erase moves the last value into the gap, so iterating visits every value
+		without gaps but in no particular order. Pointers and iterators to values are invalidated by insert and erase,
+		handles are not.
+		\n Insert, erase and lookup are O(1) (slot allocation is O(log64 n)). A handle value of 0 is never returned.
+		\tparam T The type of value.
+		\tparam HANDLE The type of handle, an unsigned integer of at least 32 bits.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class T, class HANDLE = uint64_t>
+	class slot_map {
+	public:
+		typedef HANDLE handle_t;
+		typedef T value_type;
+		typedef typename std::vector<T>::iterator iterator;
+		typedef typename std::vector<T>::const_iterator const_iterator;
+
+		static_assert(std::is_unsigned<HANDLE>::value && sizeof(HANDLE) >= 4, "asmith::slot_map : HANDLE must be an unsigned integer of at least 32 bits");
+	private:
+		enum : uint32_t {
+			INDEX_BITS = sizeof(HANDLE) * 4,
+			INDEX_MASK = static_cast<uint32_t>((1ULL << INDEX_BITS) - 1),
+			GENERATION_MASK = INDEX_MASK
+		};
+
+		struct slot {
+			uint32_t generation;	//!< Incremented when the value is erased, never 0
+			uint32_t dense;			//!< The position of the value in mValues
+		};
+
+		std::vector<slot> mSlots;
+		std::vector<T> mValues;
+		std::vector<uint32_t> mDenseToSlot;				//!< The slot of each value in mValues
+		id_generator_bitmap<uint32_t, true> mSlotIDs;
+
+		static inline HANDLE make_handle(const uint32_t aIndex, const uint32_t aGeneration) throw() {
+			return static_cast<HANDLE>(static_cast<HANDLE>(aGeneration) << INDEX_BITS) | static_cast<HANDLE>(aIndex);
+		}
+
+		static inline uint32_t get_index(const HANDLE aHandle) throw() {
+			return static_cast<uint32_t>(aHandle & INDEX_MASK);
+		}
+
+		static inline uint32_t get_generation(const HANDLE aHandle) throw() {
+			return static_cast<uint32_t>((aHandle >> INDEX_BITS) & GENERATION_MASK);
+		}
+
+		/*!
+			\brief Allocate a slot for a value that has just been appended to mValues.
+		*/
+		HANDLE insert_slot() {
+			uint32_t index = 0;
+			const bool generated = mSlotIDs.try_generate(index);
+			if(! generated || index > INDEX_MASK) {
+				if(generated) mSlotIDs.free(index);
+				mValues.pop_back();
+				throw std::length_error("asmith::slot_map : Too many values");
+			}
+			if(index >= mSlots.size()) {
+				slot tmp;
+				tmp.generation = 1;
+				tmp.dense = 0;
+				mSlots.resize(index + 1, tmp);
+			}
+			slot& s = mSlots[index];
+			s.dense = static_cast<uint32_t>(mValues.size() - 1);
+			mDenseToSlot.push_back(index);
+			return make_handle(index, s.generation);
+		}
+
+		/*!
+			\brief Find the slot of a handle.
+			\return The slot, or nullptr if the handle is not valid.
+		*/
+		inline const slot* find(const HANDLE aHandle) const throw() {
+			const uint32_t index = get_index(aHandle);
+			if(index >= mSlots.size()) return nullptr;
+			const slot& s = mSlots[index];
+			return s.generation == get_generation(aHandle) && mSlotIDs.is_used(index) ? &s : nullptr;
+		}
+	public:
+		/*!
+			\brief Insert a value.
+			\return The handle of the value.
+		*/
+		HANDLE insert(const T& aValue) {
+			mValues.push_back(aValue);
+			return insert_slot();
+		}
+
+		HANDLE insert(T&& aValue) {
+			mValues.push_back(std::move(aValue));
+			return insert_slot();
+		}
+
+		/*!
+			\brief Construct a value in place.
+			\return The handle of the value.
+		*/
+		template<class ...PARAMS>
+		HANDLE emplace(PARAMS&&... aParams) {
+			mValues.emplace_back(std::forward<PARAMS>(aParams)...);
+			return insert_slot();
+		}
+
+		/*!
+			\brief Erase a value.
+			\return False if the handle is not valid.
+		*/
+		bool erase(const HANDLE aHandle) {
+			if(find(aHandle) == nullptr) return false;
+			const uint32_t index = get_index(aHandle);
+			slot& s = mSlots[index];
+
+			// Move the last value into the gap
+			const uint32_t last = static_cast<uint32_t>(mValues.size() - 1);
+			if(s.dense != last) {
+				mValues[s.dense] = std::move(mValues[last]);
+				mDenseToSlot[s.dense] = mDenseToSlot[last];
+				mSlots[mDenseToSlot[last]].dense = s.dense;
+			}
+			mValues.pop_back();
+			mDenseToSlot.pop_back();
+
+			s.generation = (s.generation + 1) & GENERATION_MASK;
+			if(s.generation == 0) s.generation = 1;
+			mSlotIDs.free(index);
+			return true;
+		}
+
+		/*!
+			\brief Check if a handle refers to a value.
+		*/
+		bool contains(const HANDLE aHandle) const throw() {
+			return find(aHandle) != nullptr;
+		}
+
+		/*!
+			\brief Get the value of a handle.
+			\return The value, or nullptr if the handle is not valid.
+		*/
+		T* get(const HANDLE aHandle) throw() {
+			const slot* const s = find(aHandle);
+			return s ? &mValues[s->dense] : nullptr;
+		}
+
+		const T* get(const HANDLE aHandle) const throw() {
+			const slot* const s = find(aHandle);
+			return s ? &mValues[s->dense] : nullptr;
+		}
+
+		/*!
+			\brief Get the value of a handle.
+			\throw std::out_of_range If the handle is not valid.
+		*/
+		T& at(const HANDLE aHandle) {
+			T* const tmp = get(aHandle);
+			if(tmp == nullptr) throw std::out_of_range("asmith::slot_map : Handle is not valid");
+			return *tmp;
+		}
+
+		const T& at(const HANDLE aHandle) const {
+			const T* const tmp = get(aHandle);
+			if(tmp == nullptr) throw std::out_of_range("asmith::slot_map : Handle is not valid");
+			return *tmp;
+		}
+
+		/*!
+			\brief Get the handle of the value at a position in the value array.
+			\param aIndex The position, must be less than size().
+		*/
+		HANDLE get_handle(const size_t aIndex) const throw() {
+			const uint32_t index = mDenseToSlot[aIndex];
+			return make_handle(index, mSlots[index].generation);
+		}
+
+		/*!
+			\brief Erase every value, all existing handles become invalid.
+		*/
+		void clear() {
+			for(const uint32_t i : mDenseToSlot) {
+				slot& s = mSlots[i];
+				s.generation = (s.generation + 1) & GENERATION_MASK;
+				if(s.generation == 0) s.generation = 1;
+				mSlotIDs.free(i);
+			}
+			mValues.clear();
+			mDenseToSlot.clear();
+		}
+
+		void reserve(const size_t aSize) {
+			mValues.reserve(aSize);
+			mDenseToSlot.reserve(aSize);
+			mSlots.reserve(aSize);
+		}
+
+		size_t size() const throw() {
+			return mValues.size();
+		}
+
+		bool empty() const throw() {
+			return mValues.empty();
+		}
+
+		/*!
+			\brief Get the values as a contiguous array.
+		*/
+		T* data() throw() {
+			return mValues.data();
+		}
+
+		const T* data() const throw() {
+			return mValues.data();
+		}
+
+		iterator begin() throw() {
+			return mValues.begin();
+		}
+
+		iterator end() throw() {
+			return mValues.end();
+		}
+
+		const_iterator begin() const throw() {
+			return mValues.begin();
+		}
+
+		const_iterator end() const throw() {
+			return mValues.end();
+		}
+	};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,367 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_SPARSE_SET_HPP
+#define ASMITH_UTILITIES_SPARSE_SET_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "id_holder.hpp"
+
+namespace asmith {
+
+	/*!
+		\brief A map from IDs to values with contiguous value storage.
+		\detail The sparse array maps an ID to the position of its value in the dense arrays. It is split into pages of
+		PAGE_SIZE entries that are only allocated while they contain an ID, so a sparse ID space does not cost memory for
+		the gaps. The dense arrays hold the IDs and values with no gaps, erase moves the last element into the hole.
+		\n Insert, erase, contains and lookup are O(1), iterating is a linear walk over the values. Pointers and
+		iterators are invalidated by insert, erase, sort and group_with (which reorders both sets).
+		\tparam ID The type of ID, an unsigned integer.
+		\tparam T The type of value.
+		\tparam PAGE_SIZE The number of IDs per page of the sparse array.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class ID, class T, size_t PAGE_SIZE = 4096>
+	class sparse_set {
+	public:
+		typedef ID id_t;
+		typedef T value_type;
+		typedef typename std::vector<T>::iterator iterator;
+		typedef typename std::vector<T>::const_iterator const_iterator;
+
+		static_assert(std::is_unsigned<ID>::value, "asmith::sparse_set : ID must be an unsigned integer");
+		static_assert(PAGE_SIZE > 0 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0, "asmith::sparse_set : PAGE_SIZE must be a power of 2");
+	private:
+		template<class ID2, class T2, size_t PAGE_SIZE2>
+		friend class sparse_set;
+
+		enum : uint32_t {
+			NONE = ~0U
+		};
+
+		struct page {
+			uint32_t dense[PAGE_SIZE];	//!< Position of each ID in the dense arrays, or NONE
+			uint32_t count;				//!< Number of IDs in the page
+
+			page() :
+				count(0)
+			{
+				std::fill(dense, dense + PAGE_SIZE, static_cast<uint32_t>(NONE));
+			}
+		};
+
+		std::vector<std::unique_ptr<page>> mPages;
+		std::vector<ID> mIDs;
+		std::vector<T> mValues;
+
+		inline uint32_t find(const ID aID) const throw() {
+			const size_t p = static_cast<size_t>(aID / PAGE_SIZE);
+			if(p >= mPages.size() || ! mPages[p]) return NONE;
+			return mPages[p]->dense[aID % PAGE_SIZE];
+		}
+
+		inline uint32_t& sparse(const ID aID) throw() {
+			return mPages[static_cast<size_t>(aID / PAGE_SIZE)]->dense[aID % PAGE_SIZE];
+		}
+
+		/*!
+			\brief Add an ID to the sparse array, the value must already be at the back of the dense array.
+		*/
+		void link(const ID aID) {
+			const size_t p = static_cast<size_t>(aID / PAGE_SIZE);
+			if(p >= mPages.size()) mPages.resize(p + 1);
+			if(! mPages[p]) mPages[p].reset(new page());
+			page& pg = *mPages[p];
+			pg.dense[aID % PAGE_SIZE] = static_cast<uint32_t>(mIDs.size());
+			++pg.count;
+			mIDs.push_back(aID);
+		}
+
+		/*!
+			\brief Exchange two elements of the dense arrays.
+		*/
+		void swap_dense(const uint32_t aA, const uint32_t aB) {
+			if(aA == aB) return;
+			std::swap(mValues[aA], mValues[aB]);
+			std::swap(mIDs[aA], mIDs[aB]);
+			sparse(mIDs[aA]) = aA;
+			sparse(mIDs[aB]) = aB;
+		}
+
+		/*!
+			\brief Reorder the dense arrays.
+			\param aOrder aOrder[i] is the current position of the element that should be moved to position i.
+		*/
+		void apply_order(std::vector<uint32_t>& aOrder) {
+			// Follow each cycle of the permutation
+			const uint32_t size = static_cast<uint32_t>(aOrder.size());
+			for(uint32_t i = 0; i < size; ++i) {
+				uint32_t current = i;
+				while(aOrder[current] != i) {
+					const uint32_t next = aOrder[current];
+					swap_dense(current, next);
+					aOrder[current] = current;
+					current = next;
+				}
+				aOrder[current] = current;
+			}
+		}
+	public:
+		/*!
+			\brief Insert a value.
+			\return A pointer to the value and true, or a pointer to the existing value and false if the ID is already in the set.
+		*/
+		template<class ...PARAMS>
+		std::pair<T*, bool> emplace(const ID aID, PARAMS&&... aParams) {
+			const uint32_t index = find(aID);
+			if(index != NONE) return std::pair<T*, bool>(&mValues[index], false);
+			mValues.emplace_back(std::forward<PARAMS>(aParams)...);
+			link(aID);
+			return std::pair<T*, bool>(&mValues.back(), true);
+		}
+
+		std::pair<T*, bool> insert(const ID aID, const T& aValue) {
+			return emplace(aID, aValue);
+		}
+
+		std::pair<T*, bool> insert(const ID aID, T&& aValue) {
+			return emplace(aID, std::move(aValue));
+		}
+
+		std::pair<T*, bool> insert(const id_holder<ID>& aHolder, const T& aValue) {
+			return emplace(aHolder.get_id(), aValue);
+		}
+
+		std::pair<T*, bool> insert(const id_holder<ID>& aHolder, T&& aValue) {
+			return emplace(aHolder.get_id(), std::move(aValue));
+		}
+
+		/*!
+			\brief Remove an ID and its value.
+			\detail The last value is moved into its place. The page containing the ID is released if it becomes empty.
+			\return False if the ID was not in the set.
+		*/
+		bool erase(const ID aID) {
+			const uint32_t index = find(aID);
+			if(index == NONE) return false;
+			const uint32_t last = static_cast<uint32_t>(mIDs.size() - 1);
+			swap_dense(index, last);
+			mValues.pop_back();
+			mIDs.pop_back();
+
+			const size_t p = static_cast<size_t>(aID / PAGE_SIZE);
+			page& pg = *mPages[p];
+			pg.dense[aID % PAGE_SIZE] = NONE;
+			if(--pg.count == 0) {
+				mPages[p].reset();
+				while(! mPages.empty() && ! mPages.back()) mPages.pop_back();
+			}
+			return true;
+		}
+
+		bool erase(const id_holder<ID>& aHolder) {
+			return erase(aHolder.get_id());
+		}
+
+		bool contains(const ID aID) const throw() {
+			return find(aID) != NONE;
+		}
+
+		bool contains(const id_holder<ID>& aHolder) const throw() {
+			return find(aHolder.get_id()) != NONE;
+		}
+
+		/*!
+			\brief Get the value of an ID.
+			\return The value, or nullptr if the ID is not in the set.
+		*/
+		T* get(const ID aID) throw() {
+			const uint32_t index = find(aID);
+			return index == NONE ? nullptr : &mValues[index];
+		}
+
+		const T* get(const ID aID) const throw() {
+			const uint32_t index = find(aID);
+			return index == NONE ? nullptr : &mValues[index];
+		}
+
+		T* get(const id_holder<ID>& aHolder) throw() {
+			return get(aHolder.get_id());
+		}
+
+		const T* get(const id_holder<ID>& aHolder) const throw() {
+			return get(aHolder.get_id());
+		}
+
+		/*!
+			\brief Get the position of an ID in the dense arrays.
+			\return The position, or size() if the ID is not in the set.
+		*/
+		size_t index_of(const ID aID) const throw() {
+			const uint32_t index = find(aID);
+			return index == NONE ? mIDs.size() : index;
+		}
+
+		/*!
+			\brief Sort the values by ID.
+		*/
+		void sort() {
+			std::vector<uint32_t> order(mIDs.size());
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [this](const uint32_t a, const uint32_t b) {
+				return mIDs[a] < mIDs[b];
+			});
+			apply_order(order);
+		}
+
+		/*!
+			\brief Sort the values.
+			\param aCompare A function that returns true if the first value should be ordered before the second.
+		*/
+		template<class COMPARE>
+		void sort(COMPARE aCompare) {
+			std::vector<uint32_t> order(mIDs.size());
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [this, &aCompare](const uint32_t a, const uint32_t b) {
+				return aCompare(mValues[a], mValues[b]);
+			});
+			apply_order(order);
+		}
+
+		/*!
+			\brief Move the IDs that are in both this set and another set to the front of both sets.
+			\detail Afterwards the first N elements of both sets have the same IDs at the same positions, so they
+			can be iterated together without lookups. The shared IDs keep their relative order from aOther.
+			Only IDs in aOther are visited, so this is O(aOther.size()).
+			\param aOther The other set, which is also reordered.
+			\return N, the number of shared IDs.
+		*/
+		template<class T2, size_t PAGE_SIZE2>
+		size_t group_with(sparse_set<ID, T2, PAGE_SIZE2>& aOther) {
+			if(static_cast<const void*>(&aOther) == static_cast<const void*>(this)) return size();
+			uint32_t count = 0;
+			const uint32_t size = static_cast<uint32_t>(aOther.size());
+			for(uint32_t i = 0; i < size; ++i) {
+				const uint32_t index = find(aOther.mIDs[i]);
+				if(index == NONE) continue;
+				// Every element of aOther before i and at or after count is not shared, so i can be swapped forward
+				swap_dense(count, index);
+				aOther.swap_dense(count, i);
+				++count;
+			}
+			return count;
+		}
+
+		/*!
+			\brief Remove every value and release all pages.
+		*/
+		void clear() throw() {
+			mPages.clear();
+			mIDs.clear();
+			mValues.clear();
+		}
+
+		void reserve(const size_t aSize) {
+			mIDs.reserve(aSize);
+			mValues.reserve(aSize);
+		}
+
+		size_t size() const throw() {
+			return mIDs.size();
+		}
+
+		bool empty() const throw() {
+			return mIDs.empty();
+		}
+
+		/*!
+			\brief Get the number of pages of the sparse array that are allocated.
+		*/
+		size_t page_count() const throw() {
+			size_t tmp = 0;
+			for(const std::unique_ptr<page>& i : mPages) if(i) ++tmp;
+			return tmp;
+		}
+
+		/*!
+			\brief Get the IDs, in the same order as the values.
+		*/
+		const ID* ids() const throw() {
+			return mIDs.data();
+		}
+
+		T* data() throw() {
+			return mValues.data();
+		}
+
+		const T* data() const throw() {
+			return mValues.data();
+		}
+
+		iterator begin() throw() {
+			return mValues.begin();
+		}
+
+		iterator end() throw() {
+			return mValues.end();
+		}
+
+		const_iterator begin() const throw() {
+			return mValues.begin();
+		}
+
+		const_iterator end() const throw() {
+			return mValues.end();
+		}
+	};
+
+	namespace implementation {
+		template<class ID>
+		inline bool contains_all(const ID) throw() {
+			return true;
+		}
+
+		template<class ID, class SET, class ...SETS>
+		inline bool contains_all(const ID aID, const SET& aSet, const SETS&... aSets) throw() {
+			return aSet.contains(aID) && contains_all(aID, aSets...);
+		}
+	}
+
+	/*!
+		\brief Call a function for every ID that is in all of several sparse sets.
+		\detail The first set is iterated and the others are looked up, so it should be the smallest.
+		Sets must not be modified by the function.
+		\param aFunction Called with the ID followed by a reference to the value from each set.
+		\param aFirst The set to iterate.
+		\param aOthers The other sets.
+	*/
+	template<class F, class ID, class T, size_t PAGE_SIZE, class ...SETS>
+	void for_each_intersection(F&& aFunction, sparse_set<ID, T, PAGE_SIZE>& aFirst, SETS&... aOthers) {
+		const size_t size = aFirst.size();
+		const ID* const ids = aFirst.ids();
+		T* const values = aFirst.data();
+		for(size_t i = 0; i < size; ++i) {
+			const ID id = ids[i];
+			if(implementation::contains_all(id, aOthers...)) aFunction(id, values[i], *aOthers.get(id)...);
+		}
+	}
+}
+#endif
\ No newline at end of file
@@ -14,11 +14,15 @@
 #ifndef ASMITH_UTILITIES_STANDARD_DEVIATION_HPP
 #define ASMITH_UTILITIES_STANDARD_DEVIATION_HPP
 
+#include <cmath>
+#include <type_traits>
+#include "parallel_reduction.hpp"
+
 namespace asmith {
 
 	namespace implementation {
 		template<class T, class I>
-		T standard_deviation(const I aBegin, const I aEnd, const bool aSample) {
+		T standard_deviation(const I aBegin, const I aEnd, const bool aSample, std::false_type) {
 			// Calculate the mean
 			size_t size = 0;
 			T mean = static_cast<T>(0);
@@ -38,6 +42,18 @@ namespace asmith {
 			// Calculate the standard deviation
 			return std::sqrt(variance);
 		}
+
+		template<class T, class I>
+		T standard_deviation(const I aBegin, const I aEnd, const bool aSample, std::true_type) {
+			// Calculate the mean and variance in a single pass
+			const moments<double> tmp = compute_moments(aBegin, static_cast<size_t>(aEnd - aBegin));
+			return static_cast<T>(std::sqrt(tmp.variance(aSample)));
+		}
+
+		template<class T, class I>
+		inline T standard_deviation(const I aBegin, const I aEnd, const bool aSample) {
+			return standard_deviation<T, I>(aBegin, aEnd, aSample, std::integral_constant<bool, is_reducible<I>::value>());
+		}
 	}
 
 	template<class T, class I>
@@ -49,5 +65,51 @@ namespace asmith {
 	inline T standard_deviation_sample(const I aBegin, const I aEnd) {
 		return implementation::standard_deviation<T, I>(aBegin, aEnd, true);
 	}
+
+	/*!
+		\brief Calculate the population standard deviation of a range, optionally using several threads.
+		\detail Partial results are combined with Chan's merge in a fixed order so the result is the same on every run.
+		\param aPolicy How the work is split across threads.
+		\param aBegin The first element, must be a random access iterator.
+		\param aEnd The end of the range.
+	*/
+	template<class T, class I>
+	inline T standard_deviation_population(const reduction_policy aPolicy, const I aBegin, const I aEnd) {
+		return static_cast<T>(std::sqrt(implementation::compute_moments(aPolicy, aBegin, aEnd).variance(false)));
+	}
+
+	/*!
+		\brief Calculate the sample standard deviation of a range, optionally using several threads.
+		\detail Partial results are combined with Chan's merge in a fixed order so the result is the same on every run.
+		\param aPolicy How the work is split across threads.
+		\param aBegin The first element, must be a random access iterator.
+		\param aEnd The end of the range.
+	*/
+	template<class T, class I>
+	inline T standard_deviation_sample(const reduction_policy aPolicy, const I aBegin, const I aEnd) {
+		return static_cast<T>(std::sqrt(implementation::compute_moments(aPolicy, aBegin, aEnd).variance(true)));
+	}
+
+	/*!
+		\brief Calculate the population standard deviation of a range using the threads of a pool.
+		\param aPool The pool to run on.
+		\param aBegin The first element, must be a random access iterator.
+		\param aEnd The end of the range.
+	*/
+	template<class T, class I>
+	inline T standard_deviation_population(thread_pool& aPool, const I aBegin, const I aEnd) {
+		return static_cast<T>(std::sqrt(implementation::compute_moments(aPool, aBegin, aEnd).variance(false)));
+	}
+
+	/*!
+		\brief Calculate the sample standard deviation of a range using the threads of a pool.
+		\param aPool The pool to run on.
+		\param aBegin The first element, must be a random access iterator.
+		\param aEnd The end of the range.
+	*/
+	template<class T, class I>
+	inline T standard_deviation_sample(thread_pool& aPool, const I aBegin, const I aEnd) {
+		return static_cast<T>(std::sqrt(implementation::compute_moments(aPool, aBegin, aEnd).variance(true)));
+	}
 }
 #endif
\ No newline at end of file
@@ -14,6 +14,7 @@
 #ifndef ASMITH_UTILITIES_STRINGS_HPP
 #define ASMITH_UTILITIES_STRINGS_HPP
 
+#include <cstddef>
 #include <cstdint>
 
 namespace asmith { namespace strings {
@@ -0,0 +1,34 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_THREAD_INDEX_HPP
+#define ASMITH_UTILITIES_THREAD_INDEX_HPP
+
+#include <cstdint>
+#include <atomic>
+
+namespace asmith {
+
+	namespace implementation {
+		/*!
+			\brief Get a small integer that identifies the calling thread, assigned in the order that threads first call this.
+			\detail Used to pick a per-thread shard of a concurrent data structure. Indices are not reused when threads exit.
+		*/
+		inline uint32_t thread_index() throw() {
+			static std::atomic<uint32_t> NEXT_INDEX(0);
+			static thread_local const uint32_t INDEX = NEXT_INDEX.fetch_add(1, std::memory_order_relaxed);
+			return INDEX;
+		}
+	}
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,447 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_THREAD_POOL_HPP
+#define ASMITH_UTILITIES_THREAD_POOL_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace asmith {
+
+	class task_group;
+
+	namespace implementation {
+		enum : size_t {
+			THREAD_POOL_PADDING = 128,			//!< Stride between members written by different threads, so that they never share a cache line
+			WORK_STEALING_CAPACITY = 1 << 12,	//!< Number of tasks that fit in a worker's deque, tasks beyond this run immediately
+			GRAIN_TASKS_PER_THREAD = 8			//!< Number of tasks per thread that automatic grain sizing aims for
+		};
+
+		/*!
+			\brief A unit of work queued in a thread_pool.
+		*/
+		struct pool_task {
+			std::function<void()> function;		//!< The work to do
+			task_group* group;					//!< The group that is waiting for the task
+		};
+
+		/*!
+			\brief A fixed capacity Chase-Lev work-stealing deque.
+			\detail The owning thread pushes and pops at the bottom, other threads steal from the top. Only a single task
+			at the top can be contended, which is resolved with one compare and swap.
+		*/
+		class work_stealing_deque {
+		private:
+			enum : int64_t {
+				MASK = WORK_STEALING_CAPACITY - 1
+			};
+
+			std::atomic<pool_task*> mTasks[WORK_STEALING_CAPACITY];
+			std::atomic<int64_t> mTop;			//!< Next position to steal from
+			uint8_t mPadding[THREAD_POOL_PADDING - sizeof(std::atomic<int64_t>)];
+			std::atomic<int64_t> mBottom;		//!< Next position to push to, only written by the owner
+
+			work_stealing_deque(const work_stealing_deque&) = delete;
+			work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+		public:
+			work_stealing_deque() throw() :
+				mTop(0),
+				mBottom(0)
+			{
+				for(std::atomic<pool_task*>& i : mTasks) i.store(nullptr, std::memory_order_relaxed);
+			}
+
+			/*!
+				\brief Add a task to the bottom, may only be called by the owning thread.
+				\return False if the deque is full.
+			*/
+			bool push(pool_task* const aTask) throw() {
+				const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+				const int64_t top = mTop.load(std::memory_order_acquire);
+				if(bottom - top >= static_cast<int64_t>(WORK_STEALING_CAPACITY)) return false;
+				mTasks[bottom & MASK].store(aTask, std::memory_order_relaxed);
+				mBottom.store(bottom + 1, std::memory_order_release);
+				return true;
+			}
+
+			/*!
+				\brief Remove the most recently pushed task, may only be called by the owning thread.
+				\return The task, or nullptr if the deque is empty.
+			*/
+			pool_task* pop() throw() {
+				const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+				mBottom.store(bottom, std::memory_order_seq_cst);
+				int64_t top = mTop.load(std::memory_order_seq_cst);
+				if(top > bottom) {
+					mBottom.store(bottom + 1, std::memory_order_relaxed);
+					return nullptr;
+				}
+
+				pool_task* task = mTasks[bottom & MASK].load(std::memory_order_relaxed);
+				if(top == bottom) {
+					// Last task, race against thieves for it
+					if(! mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) task = nullptr;
+					mBottom.store(bottom + 1, std::memory_order_relaxed);
+				}
+				return task;
+			}
+
+			/*!
+				\brief Remove the oldest task, may be called by any thread.
+				\return The task, or nullptr if the deque is empty or another thread took it first.
+			*/
+			pool_task* steal() throw() {
+				int64_t top = mTop.load(std::memory_order_seq_cst);
+				const int64_t bottom = mBottom.load(std::memory_order_seq_cst);
+				if(top >= bottom) return nullptr;
+				pool_task* const task = mTasks[top & MASK].load(std::memory_order_acquire);
+				if(! mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+				return task;
+			}
+
+			/*!
+				\brief Check if the deque appears to be empty.
+			*/
+			bool empty() const throw() {
+				return mTop.load(std::memory_order_seq_cst) >= mBottom.load(std::memory_order_seq_cst);
+			}
+		};
+
+		/*!
+			\brief Pick a grain size that splits a range into a few tasks per thread.
+		*/
+		inline size_t automatic_grain(const size_t aSize, const size_t aThreads) throw() {
+			const size_t grain = aSize / (aThreads * GRAIN_TASKS_PER_THREAD);
+			return grain == 0 ? 1 : grain;
+		}
+	}
+
+	/*!
+		\brief Settings for a thread_pool.
+	*/
+	struct thread_pool_options {
+		size_t threads;			//!< Number of worker threads, 0 creates one less than the number of hardware threads
+		bool pin_threads;		//!< If true each worker is bound to a single CPU, ignored where affinity is not supported
+
+		thread_pool_options() :
+			threads(0),
+			pin_threads(false)
+		{}
+	};
+
+	/*!
+		\brief A work-stealing thread pool.
+		\detail Each worker owns a Chase-Lev deque. Tasks spawned by a worker go to the bottom of its own deque and are
+		run most recent first, idle workers steal the oldest (and usually largest) task from the top of another worker's
+		deque. Tasks submitted from threads outside of the pool go to a shared queue. Workers spin briefly and then sleep
+		until new work is submitted.
+		\n Threads that wait for a task_group help by running queued tasks, so the calling thread counts towards the
+		concurrency and a pool with no workers still completes every task.
+		\n get_default returns a pool shared across the library, which is created the first time it is used.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class thread_pool {
+	private:
+		struct worker;
+
+		std::vector<std::unique_ptr<worker>> mWorkers;
+		size_t mWorkerCount;							//!< Number of workers whose threads were started
+		std::mutex mQueueLock;
+		std::deque<implementation::pool_task*> mQueue;	//!< Tasks submitted from threads outside of the pool
+		std::atomic<size_t> mQueueSize;
+		std::mutex mSleepLock;
+		std::condition_variable mSleepCondition;
+		std::atomic<uint32_t> mSleeping;				//!< Number of workers that are sleeping or about to sleep
+		uint64_t mGeneration;							//!< Incremented under mSleepLock each time sleeping workers are woken
+		bool mStopping;
+
+		thread_pool(const thread_pool&) = delete;
+		thread_pool& operator=(const thread_pool&) = delete;
+
+		static worker*& current_worker() throw();
+		void worker_main(worker* const aWorker, const bool aPin);
+		implementation::pool_task* find_task(worker* const aWorker) throw();
+		bool has_work() throw();
+		void wake() throw();
+		static void execute(implementation::pool_task* const aTask) throw();
+	public:
+		/*!
+			\brief Create a pool and start its worker threads.
+		*/
+		thread_pool(const thread_pool_options& aOptions = thread_pool_options());
+
+		/*!
+			\brief Stop the workers after all queued tasks have been run.
+		*/
+		~thread_pool();
+
+		/*!
+			\brief Get the pool shared across the library.
+		*/
+		static thread_pool& get_default();
+
+		/*!
+			\brief Get the number of worker threads.
+		*/
+		size_t get_worker_count() const throw();
+
+		/*!
+			\brief Get the number of threads that can run tasks at once, the workers plus the thread that waits.
+		*/
+		size_t get_concurrency() const throw();
+
+		/*!
+			\brief Check if the calling thread is one of this pool's workers.
+		*/
+		bool is_worker() const throw();
+
+		/*!
+			\brief Queue a task.
+			\detail Prefer task_group::run, which creates the task. If the calling thread's deque is full the task is
+			run immediately.
+		*/
+		void submit(implementation::pool_task* const aTask);
+
+		/*!
+			\brief Run one queued task on the calling thread.
+			\return False if no task could be found.
+		*/
+		bool run_one() throw();
+
+		friend class task_group;
+	};
+
+	/*!
+		\brief A set of tasks that can be waited on and cancelled together.
+		\detail Tasks may add more tasks to the group that is running them. If a task throws then the group is
+		cancelled and the first exception is rethrown by wait. Tasks that have not started when the group is cancelled
+		are skipped, running tasks can poll is_cancelled to stop early.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class task_group {
+	private:
+		thread_pool& mPool;
+		std::atomic<size_t> mPending;		//!< Number of tasks that have been queued but have not finished
+		std::atomic<bool> mCancelled;
+		std::mutex mExceptionLock;
+		std::exception_ptr mException;		//!< The first exception thrown by a task
+
+		task_group(const task_group&) = delete;
+		task_group& operator=(const task_group&) = delete;
+
+		void set_exception(const std::exception_ptr aException) throw() {
+			{
+				std::lock_guard<std::mutex> lock(mExceptionLock);
+				if(! mException) mException = aException;
+			}
+			cancel();
+		}
+	public:
+		/*!
+			\brief Create an empty group.
+			\param aPool The pool to run tasks on.
+		*/
+		explicit task_group(thread_pool& aPool = thread_pool::get_default()) :
+			mPool(aPool),
+			mPending(0),
+			mCancelled(false)
+		{}
+
+		/*!
+			\brief Wait for any tasks that are still running, exceptions are discarded.
+		*/
+		~task_group() {
+			try {
+				wait();
+			}catch(...) {
+				// Destructors must not throw
+			}
+		}
+
+		/*!
+			\brief Queue a task.
+			\param aFunction Called with no arguments on one of the pool's threads, or on a thread that is waiting.
+		*/
+		template<class F>
+		void run(F&& aFunction) {
+			std::unique_ptr<implementation::pool_task> task(new implementation::pool_task());
+			task->function = std::forward<F>(aFunction);
+			task->group = this;
+			mPending.fetch_add(1, std::memory_order_relaxed);
+			mPool.submit(task.release());
+		}
+
+		/*!
+			\brief Run queued tasks on the calling thread until every task in the group has finished.
+			\detail The group can be reused afterwards.
+			\return False if the group was cancelled.
+			\throw The first exception that was thrown by a task.
+		*/
+		bool wait() {
+			while(mPending.load(std::memory_order_acquire) != 0) {
+				if(! mPool.run_one()) std::this_thread::yield();
+			}
+
+			const bool cancelled = mCancelled.exchange(false, std::memory_order_acq_rel);
+			std::exception_ptr exception;
+			{
+				std::lock_guard<std::mutex> lock(mExceptionLock);
+				exception.swap(mException);
+			}
+			if(exception) std::rethrow_exception(exception);
+			return ! cancelled;
+		}
+
+		/*!
+			\brief Skip every task in the group that has not started yet.
+		*/
+		void cancel() throw() {
+			mCancelled.store(true, std::memory_order_release);
+		}
+
+		/*!
+			\brief Check if the group has been cancelled.
+		*/
+		bool is_cancelled() const throw() {
+			return mCancelled.load(std::memory_order_acquire);
+		}
+
+		/*!
+			\brief Get the pool that the group runs tasks on.
+		*/
+		thread_pool& get_pool() const throw() {
+			return mPool;
+		}
+
+		friend class thread_pool;
+	};
+
+	namespace implementation {
+		template<class F>
+		void parallel_for_split(task_group& aGroup, size_t aBegin, size_t aEnd, const size_t aGrain, const F& aFunction) {
+			// Queue the upper half and keep splitting the lower half, thieves take the largest remaining ranges
+			while(aEnd - aBegin > aGrain) {
+				if(aGroup.is_cancelled()) return;
+				const size_t middle = aBegin + (aEnd - aBegin) / 2;
+				const size_t end = aEnd;
+				aGroup.run([&aGroup, &aFunction, middle, end, aGrain]() {
+					parallel_for_split(aGroup, middle, end, aGrain, aFunction);
+				});
+				aEnd = middle;
+			}
+			if(! aGroup.is_cancelled()) aFunction(aBegin, aEnd);
+		}
+	}
+
+	/*!
+		\brief Queue a loop over a range of indices in a task group, without waiting for it.
+		\detail The range is split in half recursively until each part is no larger than the grain size.
+		\param aGroup The group to run the loop in, cancelling it stops the loop.
+		\param aBegin The first index.
+		\param aEnd The end of the range.
+		\param aFunction Called with the begin and end of each part, must remain valid until the group has been waited on.
+		\param aGrain The maximum number of indices in each part, 0 picks a size that gives several parts per thread.
+	*/
+	template<class F>
+	void parallel_for(task_group& aGroup, const size_t aBegin, const size_t aEnd, const F& aFunction, size_t aGrain = 0) {
+		if(aEnd <= aBegin) return;
+		if(aGrain == 0) aGrain = implementation::automatic_grain(aEnd - aBegin, aGroup.get_pool().get_concurrency());
+		implementation::parallel_for_split(aGroup, aBegin, aEnd, aGrain, aFunction);
+	}
+
+	/*!
+		\brief Run a loop over a range of indices using several threads.
+		\param aPool The pool to run on.
+		\param aBegin The first index.
+		\param aEnd The end of the range.
+		\param aFunction Called with the begin and end of each part.
+		\param aGrain The maximum number of indices in each part, 0 picks a size that gives several parts per thread.
+		\throw The first exception thrown by aFunction.
+	*/
+	template<class F>
+	void parallel_for(thread_pool& aPool, const size_t aBegin, const size_t aEnd, const F& aFunction, const size_t aGrain = 0) {
+		task_group group(aPool);
+		parallel_for(group, aBegin, aEnd, aFunction, aGrain);
+		group.wait();
+	}
+
+	/*!
+		\brief Run a loop over a range of indices using the default pool.
+		\see parallel_for
+	*/
+	template<class F>
+	void parallel_for(const size_t aBegin, const size_t aEnd, const F& aFunction, const size_t aGrain = 0) {
+		parallel_for(thread_pool::get_default(), aBegin, aEnd, aFunction, aGrain);
+	}
+
+	/*!
+		\brief Reduce a range of indices using several threads.
+		\detail The range is split into parts of the grain size, each part is reduced with aMap and the partial results
+		are combined in a balanced binary tree in index order. The result therefore only depends on the grain size and
+		never on thread scheduling.
+		\param aPool The pool to run on.
+		\param aBegin The first index.
+		\param aEnd The end of the range.
+		\param aIdentity The result for an empty range.
+		\param aMap Called with the begin and end of each part, returns the result of the part.
+		\param aCombine Combines the results of two adjacent parts, the first argument covers the lower indices.
+		\param aGrain The number of indices in each part, 0 picks a size that gives several parts per thread.
+		\return The combined result.
+		\throw The first exception thrown by aMap.
+	*/
+	template<class R, class MAP, class COMBINE>
+	R parallel_reduce(thread_pool& aPool, const size_t aBegin, const size_t aEnd, const R& aIdentity, const MAP& aMap, const COMBINE& aCombine, size_t aGrain = 0) {
+		if(aEnd <= aBegin) return aIdentity;
+		const size_t size = aEnd - aBegin;
+		if(aGrain == 0) aGrain = implementation::automatic_grain(size, aPool.get_concurrency());
+		const size_t parts = (size + aGrain - 1) / aGrain;
+
+		std::vector<R> partials(parts, aIdentity);
+		parallel_for(aPool, 0, parts, [&](const size_t aFirst, const size_t aLast) {
+			for(size_t i = aFirst; i < aLast; ++i) {
+				const size_t begin = aBegin + i * aGrain;
+				const size_t end = aEnd - begin < aGrain ? aEnd : begin + aGrain;
+				partials[i] = aMap(begin, end);
+			}
+		}, 1);
+
+		// Combine in a balanced tree, doubling the stride each pass
+		for(size_t stride = 1; stride < parts; stride *= 2) {
+			for(size_t i = 0; i + stride < parts; i += stride * 2) partials[i] = aCombine(partials[i], partials[i + stride]);
+		}
+		return partials[0];
+	}
+
+	/*!
+		\brief Reduce a range of indices using the default pool.
+		\see parallel_reduce
+	*/
+	template<class R, class MAP, class COMBINE>
+	R parallel_reduce(const size_t aBegin, const size_t aEnd, const R& aIdentity, const MAP& aMap, const COMBINE& aCombine, const size_t aGrain = 0) {
+		return parallel_reduce(thread_pool::get_default(), aBegin, aEnd, aIdentity, aMap, aCombine, aGrain);
+	}
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,381 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_TIMING_WHEEL_HPP
+#define ASMITH_UTILITIES_TIMING_WHEEL_HPP
+
+#include <cstdint>
+#include <chrono>
+#include <limits>
+#include <utility>
+#include "bit_operations.hpp"
+#include "tsc_timer.hpp"
+
+namespace asmith {
+
+	template<size_t LEVELS>
+	class timing_wheel;
+
+	/*!
+		\brief An intrusive node that can be scheduled in a timing_wheel.
+		\detail Objects with a timeout either derive from or contain a node, so scheduling does not allocate.
+		A node must be cancelled (or have expired) before it is destroyed.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class timing_wheel_node {
+	private:
+		template<size_t LEVELS>
+		friend class timing_wheel;
+
+		enum : uint16_t {
+			UNSCHEDULED = 0xFFFF
+		};
+
+		timing_wheel_node* mNext;
+		timing_wheel_node* mPrevious;
+		uint64_t mDeadline;		//!< The tick that the node expires on
+		uint16_t mSlot;			//!< level * 64 + slot index, or UNSCHEDULED
+
+		timing_wheel_node(const timing_wheel_node&) = delete;
+		timing_wheel_node& operator=(const timing_wheel_node&) = delete;
+	public:
+		timing_wheel_node() throw() :
+			mNext(nullptr),
+			mPrevious(nullptr),
+			mDeadline(0),
+			mSlot(UNSCHEDULED)
+		{}
+
+		/*!
+			\brief Check if the node is waiting to expire.
+		*/
+		bool is_scheduled() const throw() {
+			return mSlot != UNSCHEDULED;
+		}
+
+		/*!
+			\brief Get the tick that the node will expire on.
+		*/
+		uint64_t get_deadline() const throw() {
+			return mDeadline;
+		}
+	};
+
+	/*!
+		\brief A hierarchical timing wheel for managing large numbers of timeouts.
+		\detail Each level has 64 slots, level L slots are 64^L ticks wide. Scheduling and cancelling are O(1), a node is
+		moved to a lower level at most LEVELS - 1 times before it expires. Empty slots are skipped with a bit scan of
+		each level's occupancy mask, so advancing over a long idle period does not visit every tick.
+		Deadlines beyond the range of the top level are kept in an overflow list and redistributed when it wraps.
+		\n Time is measured with tsc_clock and divided into ticks of the resolution given to the constructor.
+		Timeouts expire on the first call to advance at or after their deadline tick.
+		\n Not thread safe.
+		\tparam LEVELS The number of levels, the wheel covers 64^LEVELS ticks before using the overflow list.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<size_t LEVELS = 6>
+	class timing_wheel {
+	private:
+		enum : uint16_t {
+			SLOTS = 64,
+			SLOT_BITS = 6,
+			OVERFLOW_SLOT = LEVELS * SLOTS,
+			EXPIRING_SLOT = OVERFLOW_SLOT + 1,	//!< Nodes detached from the slot that advance_to is expiring
+			DEFERRED_SLOT = OVERFLOW_SLOT + 2	//!< Nodes rescheduled to the current tick from inside a callback
+		};
+
+		static_assert(LEVELS > 0 && LEVELS * SLOT_BITS < 64, "asmith::timing_wheel : LEVELS must be between 1 and 10");
+
+		timing_wheel_node* mSlots[LEVELS * SLOTS + 3];	//!< Heads of the slot lists, followed by the overflow, expiring and deferred lists
+		uint64_t mOccupied[LEVELS];						//!< Bit N of level L is set if slot N is not empty
+		uint64_t mCurrent;								//!< The current tick
+		uint64_t mOrigin;								//!< tsc_clock tick count of tick 0
+		double mTicksPerClockTick;						//!< Conversion from tsc_clock ticks to wheel ticks
+		std::chrono::nanoseconds mResolution;
+		size_t mSize;
+
+		timing_wheel(const timing_wheel&) = delete;
+		timing_wheel& operator=(const timing_wheel&) = delete;
+
+		void link(timing_wheel_node& aNode, const uint16_t aSlot) throw() {
+			timing_wheel_node*& head = mSlots[aSlot];
+			aNode.mSlot = aSlot;
+			aNode.mPrevious = nullptr;
+			aNode.mNext = head;
+			if(head) head->mPrevious = &aNode;
+			head = &aNode;
+			if(aSlot < OVERFLOW_SLOT) mOccupied[aSlot / SLOTS] |= 1ULL << (aSlot % SLOTS);
+		}
+
+		void unlink(timing_wheel_node& aNode) throw() {
+			const uint16_t slot = aNode.mSlot;
+			if(aNode.mPrevious) {
+				aNode.mPrevious->mNext = aNode.mNext;
+			} else {
+				mSlots[slot] = aNode.mNext;
+				if(aNode.mNext == nullptr && slot < OVERFLOW_SLOT) mOccupied[slot / SLOTS] &= ~(1ULL << (slot % SLOTS));
+			}
+			if(aNode.mNext) aNode.mNext->mPrevious = aNode.mPrevious;
+			aNode.mNext = nullptr;
+			aNode.mPrevious = nullptr;
+			aNode.mSlot = timing_wheel_node::UNSCHEDULED;
+		}
+
+		/*!
+			\brief Insert a node relative to the current tick.
+			\detail The level is the highest 6 bit group in which the deadline differs from the current tick.
+		*/
+		void insert(timing_wheel_node& aNode) throw() {
+			const uint64_t difference = aNode.mDeadline ^ mCurrent;
+			if(difference == 0) {
+				link(aNode, static_cast<uint16_t>(mCurrent % SLOTS));
+				return;
+			}
+			const size_t level = static_cast<size_t>(63 - implementation::count_leading_zeros(difference)) / SLOT_BITS;
+			if(level >= LEVELS) {
+				link(aNode, OVERFLOW_SLOT);
+			} else {
+				link(aNode, static_cast<uint16_t>(level * SLOTS + ((aNode.mDeadline >> (level * SLOT_BITS)) % SLOTS)));
+			}
+		}
+
+		/*!
+			\brief Detach every node in a slot.
+			\return The head of the detached list.
+		*/
+		timing_wheel_node* take(const uint16_t aSlot) throw() {
+			timing_wheel_node* const head = mSlots[aSlot];
+			mSlots[aSlot] = nullptr;
+			if(aSlot < OVERFLOW_SLOT) mOccupied[aSlot / SLOTS] &= ~(1ULL << (aSlot % SLOTS));
+			return head;
+		}
+
+		/*!
+			\brief Move every node in a slot to the head of another list, keeping them scheduled.
+		*/
+		void move(const uint16_t aFrom, const uint16_t aTo) throw() {
+			timing_wheel_node* node = take(aFrom);
+			while(node) {
+				timing_wheel_node* const next_node = node->mNext;
+				link(*node, aTo);
+				node = next_node;
+			}
+		}
+
+		/*!
+			\brief Put nodes left in the expiring and deferred lists back into the slot of the current tick.
+		*/
+		void restore_pending() throw() {
+			move(EXPIRING_SLOT, DEFERRED_SLOT);
+			timing_wheel_node* node = take(DEFERRED_SLOT);
+			while(node) {
+				timing_wheel_node* const next_node = node->mNext;
+				node->mDeadline = mCurrent;
+				insert(*node);
+				node = next_node;
+			}
+		}
+
+		/*!
+			\brief Find the next tick at which a slot must be expired or redistributed.
+			\param aLevel Set to the level of the slot, or LEVELS for the overflow list.
+			\return The tick, or the maximum value if the wheel is empty.
+		*/
+		uint64_t next_event(size_t& aLevel) const throw() {
+			for(size_t level = 0; level < LEVELS; ++level) {
+				const size_t shift = level * SLOT_BITS;
+				const uint64_t index = (mCurrent >> shift) % SLOTS;
+				// Level 0 includes the current slot, higher levels only contain slots after the current one
+				const uint64_t mask = level == 0 ? ~0ULL << index : index == SLOTS - 1 ? 0 : ~0ULL << (index + 1);
+				const uint64_t candidates = mOccupied[level] & mask;
+				if(candidates != 0) {
+					aLevel = level;
+					const uint64_t block = (mCurrent >> (shift + SLOT_BITS)) << (shift + SLOT_BITS);
+					return block | (static_cast<uint64_t>(implementation::count_trailing_zeros(candidates)) << shift);
+				}
+			}
+			aLevel = LEVELS;
+			if(mSlots[OVERFLOW_SLOT] == nullptr) return std::numeric_limits<uint64_t>::max();
+			const size_t shift = LEVELS * SLOT_BITS;
+			return ((mCurrent >> shift) + 1) << shift;
+		}
+	public:
+		/*!
+			\brief Create a new timing wheel.
+			\param aResolution The duration of one tick.
+		*/
+		timing_wheel(const std::chrono::nanoseconds aResolution = std::chrono::milliseconds(1)) throw() :
+			mCurrent(0),
+			mOrigin(tsc_clock::now()),
+			mTicksPerClockTick(tsc_clock::nanoseconds_per_tick() / static_cast<double>(aResolution.count())),
+			mResolution(aResolution),
+			mSize(0)
+		{
+			for(timing_wheel_node*& i : mSlots) i = nullptr;
+			for(uint64_t& i : mOccupied) i = 0;
+		}
+
+		/*!
+			\brief Get the tick that corresponds to the current time.
+		*/
+		uint64_t now() const throw() {
+			return static_cast<uint64_t>(static_cast<double>(tsc_clock::now() - mOrigin) * mTicksPerClockTick);
+		}
+
+		/*!
+			\brief Get the tick that the wheel has advanced to.
+		*/
+		uint64_t get_current_tick() const throw() {
+			return mCurrent;
+		}
+
+		std::chrono::nanoseconds get_resolution() const throw() {
+			return mResolution;
+		}
+
+		/*!
+			\brief Get the number of scheduled nodes.
+		*/
+		size_t size() const throw() {
+			return mSize;
+		}
+
+		bool empty() const throw() {
+			return mSize == 0;
+		}
+
+		/*!
+			\brief Schedule a node to expire on a specific tick.
+			\detail If the node is already scheduled then it is moved. Deadlines before the current tick expire on the next advance.
+			\param aNode The node.
+			\param aTick The deadline.
+		*/
+		void schedule_at(timing_wheel_node& aNode, const uint64_t aTick) throw() {
+			if(aNode.is_scheduled()) {
+				unlink(aNode);
+				--mSize;
+			}
+			aNode.mDeadline = aTick < mCurrent ? mCurrent : aTick;
+			insert(aNode);
+			++mSize;
+		}
+
+		/*!
+			\brief Schedule a node to expire after a duration.
+			\detail The duration is measured from the current time, not from the tick that the wheel has advanced to,
+			and is rounded up to a whole number of ticks.
+			\param aNode The node.
+			\param aDelay The duration.
+		*/
+		template<class REP, class PERIOD>
+		void schedule_after(timing_wheel_node& aNode, const std::chrono::duration<REP, PERIOD> aDelay) throw() {
+			const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(aDelay).count();
+			const int64_t resolution = mResolution.count();
+			const uint64_t ticks = ns <= 0 ? 0 : static_cast<uint64_t>((ns + resolution - 1) / resolution);
+			schedule_at(aNode, now() + ticks);
+		}
+
+		/*!
+			\brief Remove a node from the wheel without expiring it.
+			\return False if the node was not scheduled.
+		*/
+		bool cancel(timing_wheel_node& aNode) throw() {
+			if(! aNode.is_scheduled()) return false;
+			unlink(aNode);
+			--mSize;
+			return true;
+		}
+
+		/*!
+			\brief Get a lower bound on the next tick at which advance will do any work.
+			\detail Useful for deciding how long to sleep. It may be earlier than the next deadline if nodes need to be
+			moved to a lower level first.
+			\return The tick, or the maximum value if the wheel is empty.
+		*/
+		uint64_t get_next_tick() const throw() {
+			size_t level;
+			return next_event(level);
+		}
+
+		/*!
+			\brief Advance the wheel to a tick and expire every node with a deadline at or before it.
+			\detail Each expired node is unscheduled before the callback is called, so it can be rescheduled or
+			destroyed from inside the callback. The callback may also cancel or destroy other nodes, including ones
+			that are due on the same tick. Nodes rescheduled at or before the current tick from inside a callback
+			expire on the next advance, not this one.
+			\param aTick The tick to advance to, the wheel does not move backwards.
+			\param aCallback Called with a reference to each expired node, in deadline order.
+			\return The number of nodes that expired.
+		*/
+		template<class F>
+		size_t advance_to(const uint64_t aTick, F&& aCallback) {
+			size_t count = 0;
+			try {
+				while(true) {
+					size_t level;
+					const uint64_t next = next_event(level);
+					if(next > aTick) {
+						if(aTick > mCurrent) mCurrent = aTick;
+						break;
+					}
+					mCurrent = next;
+
+					if(level == 0) {
+						// Detach the slot so that nodes rescheduled by a callback are not expired again by this loop.
+						// Expire one node at a time from the head, the callback may cancel or destroy other detached nodes
+						const uint16_t slot = static_cast<uint16_t>(mCurrent % SLOTS);
+						move(slot, EXPIRING_SLOT);
+						while(mSlots[EXPIRING_SLOT]) {
+							timing_wheel_node& node = *mSlots[EXPIRING_SLOT];
+							unlink(node);
+							--mSize;
+							++count;
+							aCallback(node);
+						}
+						move(slot, DEFERRED_SLOT);
+					} else {
+						// Move the nodes to lower levels now that the current tick has entered their slot
+						const uint16_t slot = level == LEVELS ? 
+							static_cast<uint16_t>(OVERFLOW_SLOT) : 
+							static_cast<uint16_t>(level * SLOTS + ((mCurrent >> (level * SLOT_BITS)) % SLOTS));
+						timing_wheel_node* node = take(slot);
+						while(node) {
+							timing_wheel_node* const next_node = node->mNext;
+							insert(*node);
+							node = next_node;
+						}
+					}
+				}
+			} catch(...) {
+				restore_pending();
+				throw;
+			}
+			restore_pending();
+			return count;
+		}
+
+		/*!
+			\brief Advance the wheel to the current time and expire every node with a deadline at or before it.
+			\see advance_to
+		*/
+		template<class F>
+		size_t advance(F&& aCallback) {
+			return advance_to(now(), std::forward<F>(aCallback));
+		}
+	};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,236 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef ASMITH_UTILITIES_TSC_TIMER_HPP
+#define ASMITH_UTILITIES_TSC_TIMER_HPP
+
+#include <cstdint>
+#include <chrono>
+#include "timer.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#include <intrin.h>
+	#define ASMITH_TSC_AVAILABLE
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	#include <x86intrin.h>
+	#define ASMITH_TSC_AVAILABLE
+#endif
+
+namespace asmith {
+
+	namespace implementation {
+		/*!
+			\brief The result of calibrating the time stamp counter against std::chrono::steady_clock.
+		*/
+		struct tsc_calibration {
+			bool use_tsc;				//!< False if the TSC is not available or not invariant, steady_clock is used instead
+			bool invariant;				//!< True if the CPU reports an invariant TSC
+			double nanoseconds_per_tick;	//!< Conversion factor from ticks to nanoseconds
+		};
+
+		/*!
+			\brief Get the calibration, it is calculated the first time this is called.
+		*/
+		const tsc_calibration& get_tsc_calibration() throw();
+
+		inline uint64_t steady_clock_ticks() throw() {
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+	}
+
+	/*!
+		\brief A low overhead clock based on the CPU time stamp counter (rdtsc).
+		\detail The counter is calibrated against std::chrono::steady_clock once, the first time it is used. If the CPU
+		does not have an invariant TSC (its rate could change with frequency scaling or differ between cores) then
+		steady_clock is used instead, with 1 tick per nanosecond.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	class tsc_clock {
+	public:
+		/*!
+			\brief Read the counter.
+			\detail Not serialising, the CPU may execute neighbouring instructions before or after the read.
+			\return The current tick count.
+		*/
+		static inline uint64_t now() throw() {
+#ifdef ASMITH_TSC_AVAILABLE
+			if(implementation::get_tsc_calibration().use_tsc) return __rdtsc();
+#endif
+			return implementation::steady_clock_ticks();
+		}
+
+		/*!
+			\brief Read the counter at the beginning of a measured section.
+			\detail Earlier instructions complete before the counter is read, and later instructions do not start until it has been read.
+			\return The current tick count.
+		*/
+		static inline uint64_t now_serialising_begin() throw() {
+#ifdef ASMITH_TSC_AVAILABLE
+			if(implementation::get_tsc_calibration().use_tsc) {
+				_mm_lfence();
+				const uint64_t tmp = __rdtsc();
+				_mm_lfence();
+				return tmp;
+			}
+#endif
+			return implementation::steady_clock_ticks();
+		}
+
+		/*!
+			\brief Read the counter at the end of a measured section.
+			\detail Uses rdtscp, which waits for earlier instructions to complete, later instructions do not start until it has been read.
+			\return The current tick count.
+		*/
+		static inline uint64_t now_serialising_end() throw() {
+#ifdef ASMITH_TSC_AVAILABLE
+			if(implementation::get_tsc_calibration().use_tsc) {
+				unsigned int aux;
+				const uint64_t tmp = __rdtscp(&aux);
+				_mm_lfence();
+				return tmp;
+			}
+#endif
+			return implementation::steady_clock_ticks();
+		}
+
+		/*!
+			\brief Check if the time stamp counter is being used.
+			\return False if the clock has fallen back to std::chrono::steady_clock.
+		*/
+		static bool is_tsc() throw() {
+			return implementation::get_tsc_calibration().use_tsc;
+		}
+
+		/*!
+			\brief Check if the CPU reports an invariant time stamp counter.
+		*/
+		static bool is_invariant() throw() {
+			return implementation::get_tsc_calibration().invariant;
+		}
+
+		static double nanoseconds_per_tick() throw() {
+			return implementation::get_tsc_calibration().nanoseconds_per_tick;
+		}
+
+		/*!
+			\brief Convert a number of ticks into a duration.
+			\tparam FORMAT The unit of the result, can be any std::chrono::duration class.
+			\param aTicks The number of ticks.
+			\return The duration in FORMAT units.
+		*/
+		template<class FORMAT = std::chrono::nanoseconds>
+		static int64_t to_duration(const uint64_t aTicks) throw() {
+			const double ns = static_cast<double>(aTicks) * nanoseconds_per_tick();
+			return static_cast<int64_t>(std::chrono::duration_cast<FORMAT>(std::chrono::duration<double, std::nano>(ns)).count());
+		}
+	};
+
+	/*!
+		\brief A timer implementation that measures time with tsc_clock.
+		\detail start, pause and resume only read the counter, ticks are converted to FORMAT when get_elapsed_time is called.
+		Unlike timer, the state is stored explicitly so a clock reading of 0 cannot be confused with a stopped timer.
+		\tparam FORMAT The measurement unit of the timer, can be any std::chrono::duration class. Default value is nanoseconds
+		\tparam SERIALISING If true then readings are fenced so that the measured instructions cannot be reordered around them.
+		This is more accurate for very short sections but adds some overhead.
+		\version 1.0
+		\data Created : 19th October 2026 Modified : 19th October 2026
+		\author Adam Smith
+	*/
+	template<class FORMAT = std::chrono::nanoseconds, bool SERIALISING = false>
+	class tsc_timer : public timer_interface {
+	private:
+		enum state : uint8_t {
+			STOPPED,
+			RUNNING,
+			PAUSED
+		};
+
+		uint64_t mElapsedTicks;	//!< Ticks counted before the last pause
+		uint64_t mRunningSince;	//!< The tick count when the timer started or resumed
+		state mState;
+
+		static inline uint64_t begin_time() throw() {
+			return SERIALISING ? tsc_clock::now_serialising_begin() : tsc_clock::now();
+		}
+
+		static inline uint64_t end_time() throw() {
+			return SERIALISING ? tsc_clock::now_serialising_end() : tsc_clock::now();
+		}
+	public:
+		/*!
+			\brief Create a new timer
+		*/
+		tsc_timer() throw() :
+			mElapsedTicks(0),
+			mRunningSince(0),
+			mState(STOPPED)
+		{}
+
+		/*!
+			\brief Get the elapsed time in ticks, without converting it.
+		*/
+		inline uint64_t get_elapsed_ticks() const throw() {
+			return mState == RUNNING ? mElapsedTicks + (end_time() - mRunningSince) : mElapsedTicks;
+		}
+
+		// Inherited from timer_interface
+
+		bool is_running() const throw() override {
+			return mState == RUNNING;
+		}
+
+		bool is_paused() const throw() override {
+			return mState == PAUSED;
+		}
+
+		bool is_stopped() const throw() override {
+			return mState == STOPPED;
+		}
+
+		bool start() throw() override {
+			if(mState != STOPPED) return false;
+			mElapsedTicks = 0;
+			mState = RUNNING;
+			mRunningSince = begin_time();
+			return true;
+		}
+
+		bool stop() throw() override {
+			if(mState == STOPPED) return false;
+			pause();
+			mState = STOPPED;
+			return true;
+		}
+
+		bool pause() throw() override {
+			if(mState != RUNNING) return false;
+			mElapsedTicks += end_time() - mRunningSince;
+			mState = PAUSED;
+			return true;
+		}
+
+		bool resume() throw() override {
+			if(mState != PAUSED) return false;
+			mState = RUNNING;
+			mRunningSince = begin_time();
+			return true;
+		}
+
+		int64_t get_elapsed_time() const throw() override {
+			return tsc_clock::to_duration<FORMAT>(get_elapsed_ticks());
+		}
+	};
+}
+#endif
\ No newline at end of file
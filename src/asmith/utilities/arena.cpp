@@ -0,0 +1,135 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#include "asmith/utilities/arena.hpp"
+#include <cstdlib>
+
+namespace asmith {
+
+	// monotonic_arena
+
+	monotonic_arena::monotonic_arena(const size_t aBlockSize) throw() :
+		mPosition(nullptr),
+		mEnd(nullptr),
+		mBlocks(nullptr),
+		mSpare(nullptr),
+		mInitial(nullptr),
+		mInitialSize(0),
+		mNextSize(aBlockSize == 0 ? 1 : aBlockSize)
+	{}
+
+	monotonic_arena::monotonic_arena(void* const aBuffer, const size_t aSize) throw() :
+		mPosition(static_cast<uint8_t*>(aBuffer)),
+		mEnd(static_cast<uint8_t*>(aBuffer) + aSize),
+		mBlocks(nullptr),
+		mSpare(nullptr),
+		mInitial(static_cast<uint8_t*>(aBuffer)),
+		mInitialSize(aSize),
+		mNextSize(aSize < implementation::ARENA_DEFAULT_BLOCK_SIZE ? implementation::ARENA_DEFAULT_BLOCK_SIZE : aSize * 2)
+	{}
+
+	monotonic_arena::~monotonic_arena() throw() {
+		release();
+	}
+
+	void* monotonic_arena::allocate_slow(const size_t aSize, const size_t aAlignment) {
+		// Block data is aligned to max_align_t, larger alignments need extra space
+		const size_t padding = aAlignment > alignof(std::max_align_t) ? aAlignment : 0;
+		if(aSize > static_cast<size_t>(-1) / 2 - padding - HEADER_SIZE) throw std::bad_alloc();
+		const size_t required = aSize + padding;
+
+		// Reuse a spare block if the first one is large enough, otherwise discard spares that are too small
+		block* b = nullptr;
+		while(mSpare != nullptr) {
+			block* const spare = mSpare;
+			mSpare = spare->next;
+			if(spare->size >= required) {
+				b = spare;
+				break;
+			}
+			std::free(spare);
+		}
+
+		if(b == nullptr) {
+			size_t size = mNextSize;
+			while(size < required) size *= 2;
+			b = static_cast<block*>(std::malloc(HEADER_SIZE + size));
+			if(b == nullptr) throw std::bad_alloc();
+			b->size = size;
+			mNextSize = size > static_cast<size_t>(-1) / 4 ? size : size * 2;
+		}
+
+		b->next = mBlocks;
+		mBlocks = b;
+		mPosition = block_data(b);
+		mEnd = mPosition + b->size;
+
+		const uintptr_t aligned = (reinterpret_cast<uintptr_t>(mPosition) + aAlignment - 1) & ~static_cast<uintptr_t>(aAlignment - 1);
+		mPosition = reinterpret_cast<uint8_t*>(aligned + aSize);
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	void monotonic_arena::rewind(const marker aMarker) throw() {
+		// Move blocks allocated after the marker to the spare list, keeping them in allocation order
+		while(mBlocks != aMarker.block) {
+			block* const b = mBlocks;
+			mBlocks = b->next;
+			b->next = mSpare;
+			mSpare = b;
+		}
+
+		mPosition = aMarker.position;
+		if(mBlocks == nullptr) {
+			mEnd = mInitial == nullptr ? nullptr : mInitial + mInitialSize;
+		}else {
+			mEnd = block_data(mBlocks) + mBlocks->size;
+		}
+	}
+
+	void monotonic_arena::reset() throw() {
+		marker tmp;
+		tmp.block = nullptr;
+		tmp.position = mInitial;
+		rewind(tmp);
+	}
+
+	void monotonic_arena::release() throw() {
+		reset();
+		while(mSpare != nullptr) {
+			block* const b = mSpare;
+			mSpare = b->next;
+			std::free(b);
+		}
+	}
+
+	size_t monotonic_arena::get_heap_size() const throw() {
+		size_t size = 0;
+		for(const block* i = mBlocks; i != nullptr; i = i->next) size += i->size;
+		for(const block* i = mSpare; i != nullptr; i = i->next) size += i->size;
+		return size;
+	}
+
+	// scratch_scope
+
+	scratch_scope::scratch_scope() :
+		mArena(scratch_arena()),
+		mMarker(mArena.get_marker())
+	{}
+
+	// Functions
+
+	monotonic_arena& scratch_arena() {
+		static thread_local monotonic_arena ARENA(implementation::SCRATCH_BLOCK_SIZE);
+		return ARENA;
+	}
+}
\ No newline at end of file
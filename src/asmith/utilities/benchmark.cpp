@@ -0,0 +1,358 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#include "asmith/utilities/benchmark.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include "asmith/utilities/average.hpp"
+#include "asmith/utilities/standard_deviation.hpp"
+
+namespace asmith {
+
+	namespace {
+		/*!
+			\brief Two sided critical values of Student's t distribution for 1 to 30 degrees of freedom.
+		*/
+		const double T_90[30] = {
+			6.314, 2.920, 2.353, 2.132, 2.015, 1.943, 1.895, 1.860, 1.833, 1.812,
+			1.796, 1.782, 1.771, 1.761, 1.753, 1.746, 1.740, 1.734, 1.729, 1.725,
+			1.721, 1.717, 1.714, 1.711, 1.708, 1.706, 1.703, 1.701, 1.699, 1.697
+		};
+
+		const double T_95[30] = {
+			12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+			2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+			2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+		};
+
+		const double T_99[30] = {
+			63.657, 9.925, 5.841, 4.604, 4.032, 3.707, 3.499, 3.355, 3.250, 3.169,
+			3.106, 3.055, 3.012, 2.977, 2.947, 2.921, 2.898, 2.878, 2.861, 2.845,
+			2.831, 2.819, 2.807, 2.797, 2.787, 2.779, 2.771, 2.763, 2.756, 2.750
+		};
+
+		double critical_value(const double aConfidence, const size_t aDegreesOfFreedom) throw() {
+			const double* table;
+			double z;
+			if(aConfidence >= 0.985) {
+				table = T_99;
+				z = 2.576;
+			}else if(aConfidence >= 0.925) {
+				table = T_95;
+				z = 1.960;
+			}else {
+				table = T_90;
+				z = 1.645;
+			}
+			if(aDegreesOfFreedom == 0) return 0.0;
+			return aDegreesOfFreedom <= 30 ? table[aDegreesOfFreedom - 1] : z;
+		}
+
+		/*!
+			\brief Linearly interpolated quantile of sorted samples.
+		*/
+		double quantile(const std::vector<double>& aSorted, const double aQuantile) throw() {
+			const double rank = aQuantile * static_cast<double>(aSorted.size() - 1);
+			const size_t lower = static_cast<size_t>(rank);
+			if(lower + 1 >= aSorted.size()) return aSorted.back();
+			return aSorted[lower] + (aSorted[lower + 1] - aSorted[lower]) * (rank - static_cast<double>(lower));
+		}
+
+		/*!
+			\brief Calculate the mean of samples and the half width of its confidence interval.
+		*/
+		void mean_interval(const std::vector<double>& aSamples, const double aConfidence, double& aMean, double& aInterval) {
+			const double* const begin = aSamples.data();
+			const double* const end = begin + aSamples.size();
+			aMean = mean<double>(begin, end);
+			if(aSamples.size() < 2) {
+				aInterval = 0.0;
+			}else {
+				aInterval = critical_value(aConfidence, aSamples.size() - 1) * standard_deviation_sample<double>(begin, end) / std::sqrt(static_cast<double>(aSamples.size()));
+			}
+		}
+
+		/*!
+			\brief Run the benchmark function once.
+			\return The measured time in nanoseconds.
+		*/
+		double run_once(const benchmark_suite::function& aFunction, const uint64_t aIterations, const uint64_t aParameter, uint64_t& aBytes, uint64_t& aItems) {
+			benchmark_state state(aIterations, aParameter);
+			timer_interface& timer = state.get_timer();
+			timer.start();
+			aFunction(state);
+			timer.stop();
+			aBytes = state.get_bytes_per_iteration();
+			aItems = state.get_items_per_iteration();
+			return static_cast<double>(state.get_elapsed_ticks()) * tsc_clock::nanoseconds_per_tick();
+		}
+
+		void write_json_string(std::ostream& aStream, const std::string& aStr) {
+			static const char HEX[] = "0123456789abcdef";
+			aStream << '"';
+			for(const char i : aStr) {
+				const unsigned char c = static_cast<unsigned char>(i);
+				switch(c) {
+				case '"':
+					aStream << "\\\"";
+					break;
+				case '\\':
+					aStream << "\\\\";
+					break;
+				default:
+					if(c < 0x20) {
+						aStream << "\\u00" << HEX[c >> 4] << HEX[c & 15];
+					}else {
+						aStream << i;
+					}
+					break;
+				}
+			}
+			aStream << '"';
+		}
+
+		/*!
+			\brief Format a duration in the most readable unit.
+		*/
+		std::string format_time(const double aNanoseconds) {
+			char buffer[32];
+			if(aNanoseconds < 1e3) {
+				std::snprintf(buffer, sizeof(buffer), "%.2f ns", aNanoseconds);
+			}else if(aNanoseconds < 1e6) {
+				std::snprintf(buffer, sizeof(buffer), "%.2f us", aNanoseconds / 1e3);
+			}else if(aNanoseconds < 1e9) {
+				std::snprintf(buffer, sizeof(buffer), "%.2f ms", aNanoseconds / 1e6);
+			}else {
+				std::snprintf(buffer, sizeof(buffer), "%.2f s", aNanoseconds / 1e9);
+			}
+			return buffer;
+		}
+
+		/*!
+			\brief Format a rate with an SI prefix.
+		*/
+		std::string format_rate(const double aRate, const double aInterval, const char* const aUnit) {
+			static const char* const PREFIXES[] = { "", "k", "M", "G", "T" };
+			double scale = 1.0;
+			size_t prefix = 0;
+			while(prefix < 4 && aRate >= scale * 1000.0) {
+				scale *= 1000.0;
+				++prefix;
+			}
+			char buffer[64];
+			std::snprintf(buffer, sizeof(buffer), "%.2f %s%s/s +- %.1f%%", aRate / scale, PREFIXES[prefix], aUnit, aRate == 0.0 ? 0.0 : aInterval / aRate * 100.0);
+			return buffer;
+		}
+	}
+
+	// benchmark_suite
+
+	void benchmark_suite::add(const std::string& aName, function aFunction, std::vector<uint64_t> aParameters) {
+		if(aParameters.empty()) aParameters.push_back(0);
+		entry tmp;
+		tmp.name = aName;
+		tmp.fn = std::move(aFunction);
+		tmp.parameters = std::move(aParameters);
+		mBenchmarks.push_back(std::move(tmp));
+	}
+
+	benchmark_result benchmark_suite::run(const std::string& aName, const function& aFunction, const uint64_t aParameter, const benchmark_options& aOptions) {
+		const double min_time = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(aOptions.min_time).count());
+		uint64_t bytes = 0;
+		uint64_t items = 0;
+
+		// Calibrate the number of iterations so that one run takes at least min_time
+		uint64_t iterations = 1;
+		while(true) {
+			const double elapsed = run_once(aFunction, iterations, aParameter, bytes, items);
+			if(elapsed >= min_time || iterations >= (1ULL << 40)) break;
+			double multiplier = elapsed <= 0.0 ? 10.0 : (min_time / elapsed) * 1.2;
+			multiplier = std::min(10.0, std::max(1.5, multiplier));
+			iterations = static_cast<uint64_t>(std::ceil(static_cast<double>(iterations) * multiplier));
+		}
+
+		// Warm up caches, branch predictors and CPU frequency
+		const std::chrono::steady_clock::time_point warm_up_end = std::chrono::steady_clock::now() + aOptions.warm_up;
+		while(std::chrono::steady_clock::now() < warm_up_end) run_once(aFunction, iterations, aParameter, bytes, items);
+
+		const uint32_t repeats = std::max<uint32_t>(aOptions.repeats, 1);
+		std::vector<double> samples;
+		samples.reserve(repeats);
+		for(uint32_t i = 0; i < repeats; ++i) {
+			samples.push_back(run_once(aFunction, iterations, aParameter, bytes, items) / static_cast<double>(iterations));
+		}
+
+		// Reject outliers with Tukey's fences
+		uint32_t rejected = 0;
+		if(aOptions.outlier_fence > 0.0 && samples.size() >= 4) {
+			std::vector<double> sorted = samples;
+			std::sort(sorted.begin(), sorted.end());
+			const double q1 = quantile(sorted, 0.25);
+			const double q3 = quantile(sorted, 0.75);
+			const double low = q1 - (q3 - q1) * aOptions.outlier_fence;
+			const double high = q3 + (q3 - q1) * aOptions.outlier_fence;
+			const std::vector<double>::iterator end = std::remove_if(samples.begin(), samples.end(), [low, high](const double x) {
+				return x < low || x > high;
+			});
+			rejected = static_cast<uint32_t>(samples.end() - end);
+			samples.erase(end, samples.end());
+		}
+
+		benchmark_result result;
+		result.name = aName;
+		result.parameter = aParameter;
+		result.iterations = iterations;
+		result.repeats = static_cast<uint32_t>(samples.size());
+		result.rejected = rejected;
+		mean_interval(samples, aOptions.confidence, result.mean_ns, result.interval_ns);
+		result.median_ns = median<double>(samples.data(), samples.data() + samples.size());
+		result.standard_deviation_ns = samples.size() < 2 ? 0.0 : standard_deviation_sample<double>(samples.data(), samples.data() + samples.size());
+		result.min_ns = *std::min_element(samples.begin(), samples.end());
+		result.max_ns = *std::max_element(samples.begin(), samples.end());
+
+		std::vector<double> rates(samples.size());
+		result.bytes_per_second = 0.0;
+		result.bytes_per_second_interval = 0.0;
+		if(bytes != 0) {
+			for(size_t i = 0; i < samples.size(); ++i) rates[i] = static_cast<double>(bytes) / (samples[i] * 1e-9);
+			mean_interval(rates, aOptions.confidence, result.bytes_per_second, result.bytes_per_second_interval);
+		}
+		result.items_per_second = 0.0;
+		result.items_per_second_interval = 0.0;
+		if(items != 0) {
+			for(size_t i = 0; i < samples.size(); ++i) rates[i] = static_cast<double>(items) / (samples[i] * 1e-9);
+			mean_interval(rates, aOptions.confidence, result.items_per_second, result.items_per_second_interval);
+		}
+		return result;
+	}
+
+	std::vector<benchmark_result> benchmark_suite::run(const benchmark_options& aOptions, std::ostream* aProgress) const {
+		std::vector<benchmark_result> results;
+		if(aProgress) write_text_header(*aProgress);
+		for(const entry& i : mBenchmarks) {
+			if(! aOptions.filter.empty() && i.name.find(aOptions.filter) == std::string::npos) continue;
+			for(const uint64_t j : i.parameters) {
+				results.push_back(run(i.name, i.fn, j, aOptions));
+				if(aProgress) {
+					write_text(*aProgress, results.back());
+					aProgress->flush();
+				}
+			}
+		}
+		return results;
+	}
+
+	void benchmark_suite::write_text_header(std::ostream& aStream) {
+		char buffer[256];
+		std::snprintf(buffer, sizeof(buffer), "%-40s %12s %14s %8s %14s %12s %8s  %s\n", "benchmark", "iterations", "mean", "+-", "median", "stddev", "repeats", "throughput");
+		aStream << buffer;
+	}
+
+	void benchmark_suite::write_text(std::ostream& aStream, const benchmark_result& aResult) {
+		std::string name = aResult.name;
+		if(aResult.parameter != 0) name += '/' + std::to_string(aResult.parameter);
+		char buffer[512];
+		std::snprintf(buffer, sizeof(buffer), "%-40s %12llu %14s %7.1f%% %14s %12s %5u/%-2u ",
+			name.c_str(),
+			static_cast<unsigned long long>(aResult.iterations),
+			format_time(aResult.mean_ns).c_str(),
+			aResult.mean_ns == 0.0 ? 0.0 : aResult.interval_ns / aResult.mean_ns * 100.0,
+			format_time(aResult.median_ns).c_str(),
+			format_time(aResult.standard_deviation_ns).c_str(),
+			aResult.repeats,
+			aResult.repeats + aResult.rejected
+		);
+		aStream << buffer;
+		if(aResult.bytes_per_second != 0.0) aStream << ' ' << format_rate(aResult.bytes_per_second, aResult.bytes_per_second_interval, "B");
+		if(aResult.items_per_second != 0.0) aStream << ' ' << format_rate(aResult.items_per_second, aResult.items_per_second_interval, "items");
+		aStream << '\n';
+	}
+
+	void benchmark_suite::write_text(std::ostream& aStream, const std::vector<benchmark_result>& aResults) {
+		write_text_header(aStream);
+		for(const benchmark_result& i : aResults) write_text(aStream, i);
+	}
+
+	void benchmark_suite::write_json(std::ostream& aStream, const std::vector<benchmark_result>& aResults) {
+		const std::ios_base::fmtflags flags = aStream.flags();
+		const std::streamsize precision = aStream.precision();
+		aStream.setf(std::ios_base::fixed, std::ios_base::floatfield);
+		aStream.precision(3);
+
+		aStream << "{\"benchmarks\":[";
+		const size_t size = aResults.size();
+		for(size_t i = 0; i < size; ++i) {
+			const benchmark_result& r = aResults[i];
+			if(i != 0) aStream << ',';
+			aStream << "\n{\"name\":";
+			write_json_string(aStream, r.name);
+			aStream << ",\"parameter\":" << r.parameter;
+			aStream << ",\"iterations\":" << r.iterations;
+			aStream << ",\"repeats\":" << r.repeats;
+			aStream << ",\"rejected\":" << r.rejected;
+			aStream << ",\"mean_ns\":" << r.mean_ns;
+			aStream << ",\"interval_ns\":" << r.interval_ns;
+			aStream << ",\"median_ns\":" << r.median_ns;
+			aStream << ",\"stddev_ns\":" << r.standard_deviation_ns;
+			aStream << ",\"min_ns\":" << r.min_ns;
+			aStream << ",\"max_ns\":" << r.max_ns;
+			if(r.bytes_per_second != 0.0) {
+				aStream << ",\"bytes_per_second\":" << r.bytes_per_second;
+				aStream << ",\"bytes_per_second_interval\":" << r.bytes_per_second_interval;
+			}
+			if(r.items_per_second != 0.0) {
+				aStream << ",\"items_per_second\":" << r.items_per_second;
+				aStream << ",\"items_per_second_interval\":" << r.items_per_second_interval;
+			}
+			aStream << '}';
+		}
+		aStream << "\n]}\n";
+
+		aStream.flags(flags);
+		aStream.precision(precision);
+	}
+
+	int benchmark_suite::main(int aArgc, char** aArgv) const {
+		benchmark_options options;
+		bool json = false;
+		for(int i = 1; i < aArgc; ++i) {
+			const char* const arg = aArgv[i];
+			if(std::strncmp(arg, "--filter=", 9) == 0) {
+				options.filter = arg + 9;
+			}else if(std::strncmp(arg, "--repeats=", 10) == 0) {
+				options.repeats = static_cast<uint32_t>(std::strtoul(arg + 10, nullptr, 10));
+			}else if(std::strncmp(arg, "--min-time=", 11) == 0) {
+				options.min_time = std::chrono::milliseconds(std::strtoul(arg + 11, nullptr, 10));
+			}else if(std::strncmp(arg, "--warm-up=", 10) == 0) {
+				options.warm_up = std::chrono::milliseconds(std::strtoul(arg + 10, nullptr, 10));
+			}else if(std::strcmp(arg, "--json") == 0) {
+				json = true;
+			}else {
+				std::cerr << "usage : " << aArgv[0] << " [--filter=TEXT] [--repeats=N] [--min-time=MS] [--warm-up=MS] [--json]\n";
+				return std::strcmp(arg, "--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+			}
+		}
+
+		if(json) {
+			write_json(std::cout, run(options, nullptr));
+		}else {
+			run(options, &std::cout);
+		}
+		return EXIT_SUCCESS;
+	}
+}
\ No newline at end of file
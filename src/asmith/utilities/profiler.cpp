@@ -0,0 +1,409 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#include "asmith/utilities/profiler.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace asmith {
+
+	namespace {
+		enum : size_t {
+			DEFAULT_BUFFER_CAPACITY = 1 << 15,
+			DEFAULT_TRACE_CAPACITY = 1 << 16
+		};
+
+		/*!
+			\brief The running totals of one zone, in tsc_clock ticks.
+		*/
+		struct zone_ticks {
+			uint64_t count;
+			uint64_t total;
+			uint64_t min;
+			uint64_t max;
+		};
+
+		typedef std::map<std::pair<const char*, const char*>, zone_ticks> zone_map;
+
+		/*!
+			\brief The state shared by all threads.
+		*/
+		struct profiler_registry {
+			std::mutex lock;
+			std::vector<std::unique_ptr<profiler_buffer>> buffers;
+			std::vector<profiler_event> drained;	//!< Reused by collect to drain each thread buffer
+			zone_map zones;							//!< Statistics of every collected event, keyed by name and category pointers
+			std::vector<profiler_event> events;		//!< Ring of the most recent events, the oldest is at trace_head once it is full
+			std::vector<uint32_t> event_threads;	//!< The thread ID of each event in the ring
+			size_t trace_capacity;
+			size_t trace_head;
+			uint64_t overwritten;
+			uint64_t retired_dropped;
+			size_t capacity;
+			uint32_t next_thread_id;
+
+			std::thread collector;
+			std::mutex collector_lock;
+			std::condition_variable collector_condition;
+			bool collector_running;
+
+			profiler_registry() :
+				trace_capacity(DEFAULT_TRACE_CAPACITY),
+				trace_head(0),
+				overwritten(0),
+				retired_dropped(0),
+				capacity(DEFAULT_BUFFER_CAPACITY),
+				next_thread_id(0),
+				collector_running(false)
+			{}
+
+			~profiler_registry() {
+				// The static is being destroyed, so this must not go back through get_registry()
+				stop_collector();
+			}
+
+			/*!
+				\brief Add an event to the statistics and the trace ring, must be called while locked.
+			*/
+			void record(const profiler_event& aEvent, const uint32_t aThreadID) {
+				const uint64_t duration = aEvent.end - aEvent.begin;
+				zone_ticks& zone = zones[std::make_pair(aEvent.name, aEvent.category)];
+				if(zone.count == 0) {
+					zone.min = duration;
+					zone.max = duration;
+				}else {
+					zone.min = std::min(zone.min, duration);
+					zone.max = std::max(zone.max, duration);
+				}
+				zone.total += duration;
+				++zone.count;
+
+				if(trace_capacity == 0) {
+					++overwritten;
+				}else if(events.size() < trace_capacity) {
+					events.push_back(aEvent);
+					event_threads.push_back(aThreadID);
+				}else {
+					events[trace_head] = aEvent;
+					event_threads[trace_head] = aThreadID;
+					if(++trace_head == trace_capacity) trace_head = 0;
+					++overwritten;
+				}
+			}
+
+			/*!
+				\brief Rotate the trace ring so that the oldest event is first, must be called while locked.
+			*/
+			void linearise() {
+				std::rotate(events.begin(), events.begin() + trace_head, events.end());
+				std::rotate(event_threads.begin(), event_threads.begin() + trace_head, event_threads.end());
+				trace_head = 0;
+			}
+
+			size_t collect() {
+				std::lock_guard<std::mutex> guard(lock);
+				size_t count = 0;
+				for(size_t i = 0; i < buffers.size();) {
+					profiler_buffer& buffer = *buffers[i];
+					const bool retired = buffer.is_retired();
+					drained.clear();
+					buffer.drain(drained);
+					for(const profiler_event& j : drained) record(j, buffer.get_thread_id());
+					count += drained.size();
+
+					// The owning thread has exited and will not write again
+					if(retired) {
+						retired_dropped += buffer.get_dropped();
+						buffers.erase(buffers.begin() + i);
+					}else {
+						++i;
+					}
+				}
+				return count;
+			}
+
+			void stop_collector() {
+				std::thread tmp;
+				{
+					std::lock_guard<std::mutex> guard(collector_lock);
+					if(! collector_running) return;
+					collector_running = false;
+					tmp.swap(collector);
+				}
+				collector_condition.notify_all();
+				tmp.join();
+				collect();
+			}
+		};
+
+		profiler_registry& get_registry() {
+			static profiler_registry REGISTRY;
+			return REGISTRY;
+		}
+	}
+
+	/*!
+		\brief Retires the buffer of a thread when the thread exits.
+	*/
+	struct profiler::thread_registration {
+		profiler_buffer* buffer;
+
+		thread_registration() :
+			buffer(nullptr)
+		{
+			profiler_registry& registry = get_registry();
+			std::lock_guard<std::mutex> lock(registry.lock);
+			registry.buffers.push_back(std::unique_ptr<profiler_buffer>(new profiler_buffer(registry.capacity, registry.next_thread_id++)));
+			buffer = registry.buffers.back().get();
+		}
+
+		~thread_registration() {
+			// Zones recorded by later thread_local destructors must not touch the buffer once the collector can free it
+			thread_slot& slot = get_thread_slot();
+			slot.buffer = nullptr;
+			slot.retired = true;
+			buffer->retire();
+		}
+	};
+
+	namespace {
+		/*!
+			\brief Write a string as a JSON string literal.
+		*/
+		void write_json_string(std::ostream& aStream, const char* aStr) {
+			static const char HEX[] = "0123456789abcdef";
+			aStream << '"';
+			if(aStr != nullptr) {
+				for(; *aStr != '\0'; ++aStr) {
+					const unsigned char c = static_cast<unsigned char>(*aStr);
+					switch(c) {
+					case '"':
+						aStream << "\\\"";
+						break;
+					case '\\':
+						aStream << "\\\\";
+						break;
+					case '\n':
+						aStream << "\\n";
+						break;
+					case '\r':
+						aStream << "\\r";
+						break;
+					case '\t':
+						aStream << "\\t";
+						break;
+					default:
+						if(c < 0x20) {
+							aStream << "\\u00" << HEX[c >> 4] << HEX[c & 15];
+						}else {
+							aStream << *aStr;
+						}
+						break;
+					}
+				}
+			}
+			aStream << '"';
+		}
+	}
+
+	// profiler_buffer
+
+	profiler_buffer::profiler_buffer(const size_t aCapacity, const uint32_t aThreadID) :
+		mMask([aCapacity]()->uint64_t {
+			uint64_t size = 1;
+			while(size < aCapacity) size <<= 1;
+			return size - 1;
+		}()),
+		mThreadID(aThreadID),
+		mHead(0),
+		mDropped(0),
+		mTail(0),
+		mRetired(false)
+	{
+		mEvents.reset(new profiler_event[mMask + 1]);
+	}
+
+	size_t profiler_buffer::drain(std::vector<profiler_event>& aOutput) {
+		const uint64_t tail = mTail.load(std::memory_order_relaxed);
+		const uint64_t head = mHead.load(std::memory_order_acquire);
+		for(uint64_t i = tail; i != head; ++i) aOutput.push_back(mEvents[i & mMask]);
+		mTail.store(head, std::memory_order_release);
+		return static_cast<size_t>(head - tail);
+	}
+
+	// profiler
+
+	profiler_buffer* profiler::register_thread() {
+		static thread_local thread_registration REGISTRATION;
+		return REGISTRATION.buffer;
+	}
+
+	void profiler::set_buffer_capacity(const size_t aCapacity) {
+		profiler_registry& registry = get_registry();
+		std::lock_guard<std::mutex> lock(registry.lock);
+		registry.capacity = aCapacity == 0 ? 1 : aCapacity;
+	}
+
+	size_t profiler::collect() {
+		return get_registry().collect();
+	}
+
+	bool profiler::start_collector(const std::chrono::milliseconds aPeriod) {
+		profiler_registry& registry = get_registry();
+		std::lock_guard<std::mutex> lock(registry.collector_lock);
+		if(registry.collector_running) return false;
+		registry.collector_running = true;
+		registry.collector = std::thread([aPeriod, &registry]() {
+			std::unique_lock<std::mutex> lock(registry.collector_lock);
+			while(registry.collector_running) {
+				registry.collector_condition.wait_for(lock, aPeriod);
+				lock.unlock();
+				registry.collect();
+				lock.lock();
+			}
+		});
+		return true;
+	}
+
+	void profiler::stop_collector() {
+		get_registry().stop_collector();
+	}
+
+	void profiler::set_trace_capacity(const size_t aCapacity) {
+		profiler_registry& registry = get_registry();
+		std::lock_guard<std::mutex> lock(registry.lock);
+		registry.linearise();
+		if(registry.events.size() > aCapacity) {
+			// Keep the most recent events
+			const size_t excess = registry.events.size() - aCapacity;
+			registry.events.erase(registry.events.begin(), registry.events.begin() + excess);
+			registry.event_threads.erase(registry.event_threads.begin(), registry.event_threads.begin() + excess);
+			registry.overwritten += excess;
+		}
+		registry.events.shrink_to_fit();
+		registry.event_threads.shrink_to_fit();
+		registry.trace_capacity = aCapacity;
+	}
+
+	void profiler::clear() {
+		profiler_registry& registry = get_registry();
+		std::lock_guard<std::mutex> lock(registry.lock);
+		registry.events.clear();
+		registry.event_threads.clear();
+		registry.trace_head = 0;
+		registry.zones.clear();
+	}
+
+	uint64_t profiler::get_dropped() {
+		profiler_registry& registry = get_registry();
+		std::lock_guard<std::mutex> lock(registry.lock);
+		uint64_t tmp = registry.retired_dropped;
+		for(const std::unique_ptr<profiler_buffer>& i : registry.buffers) tmp += i->get_dropped();
+		return tmp;
+	}
+
+	uint64_t profiler::get_overwritten() {
+		profiler_registry& registry = get_registry();
+		std::lock_guard<std::mutex> lock(registry.lock);
+		return registry.overwritten;
+	}
+
+	std::vector<profiler_event> profiler::get_events(std::vector<uint32_t>* const aThreadIDs) {
+		profiler_registry& registry = get_registry();
+		std::lock_guard<std::mutex> lock(registry.lock);
+		registry.linearise();
+		if(aThreadIDs != nullptr) *aThreadIDs = registry.event_threads;
+		return registry.events;
+	}
+
+	std::vector<profiler::zone_statistics> profiler::get_statistics() {
+		zone_map totals;
+		{
+			profiler_registry& registry = get_registry();
+			std::lock_guard<std::mutex> lock(registry.lock);
+			totals = registry.zones;
+		}
+		const double ns_per_tick = tsc_clock::nanoseconds_per_tick();
+
+		// The same name may be stored at more than one address, so combine the totals by string
+		std::map<std::pair<std::string, std::string>, zone_statistics> zones;
+		for(const zone_map::value_type& i : totals) {
+			const std::string name = i.first.first == nullptr ? "" : i.first.first;
+			const std::string category = i.first.second == nullptr ? "" : i.first.second;
+			const zone_ticks& ticks = i.second;
+			const double min = static_cast<double>(ticks.min) * ns_per_tick;
+			const double max = static_cast<double>(ticks.max) * ns_per_tick;
+			zone_statistics& zone = zones[std::make_pair(name, category)];
+			if(zone.count == 0) {
+				zone.name = name;
+				zone.category = category;
+				zone.min = min;
+				zone.max = max;
+			}else {
+				zone.min = std::min(zone.min, min);
+				zone.max = std::max(zone.max, max);
+			}
+			zone.total += static_cast<double>(ticks.total) * ns_per_tick;
+			zone.count += ticks.count;
+		}
+
+		std::vector<zone_statistics> tmp;
+		tmp.reserve(zones.size());
+		for(const auto& i : zones) tmp.push_back(i.second);
+		std::sort(tmp.begin(), tmp.end(), [](const zone_statistics& a, const zone_statistics& b)->bool {
+			return a.total > b.total;
+		});
+		return tmp;
+	}
+
+	void profiler::write_chrome_trace(std::ostream& aStream) {
+		std::vector<uint32_t> threads;
+		const std::vector<profiler_event> events = get_events(&threads);
+		const double us_per_tick = tsc_clock::nanoseconds_per_tick() / 1000.0;
+
+		uint64_t origin = events.empty() ? 0 : events[0].begin;
+		for(const profiler_event& i : events) origin = std::min(origin, i.begin);
+
+		const std::ios_base::fmtflags flags = aStream.flags();
+		const std::streamsize precision = aStream.precision();
+		aStream.setf(std::ios_base::fixed, std::ios_base::floatfield);
+		aStream.precision(3);
+
+		aStream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+		const size_t size = events.size();
+		for(size_t i = 0; i < size; ++i) {
+			const profiler_event& e = events[i];
+			if(i != 0) aStream << ',';
+			aStream << "\n{\"name\":";
+			write_json_string(aStream, e.name);
+			aStream << ",\"cat\":";
+			write_json_string(aStream, e.category);
+			aStream << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << threads[i];
+			aStream << ",\"ts\":" << static_cast<double>(e.begin - origin) * us_per_tick;
+			aStream << ",\"dur\":" << static_cast<double>(e.end - e.begin) * us_per_tick;
+			if(e.arg_name != nullptr) {
+				aStream << ",\"args\":{";
+				write_json_string(aStream, e.arg_name);
+				aStream << ':' << e.arg_value << '}';
+			}
+			aStream << '}';
+		}
+		aStream << "\n]}\n";
+
+		aStream.flags(flags);
+		aStream.precision(precision);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,389 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#ifndef _GNU_SOURCE
+	#define _GNU_SOURCE
+#endif
+#include "asmith/utilities/sampling_profiler.hpp"
+
+#ifdef ASMITH_SAMPLING_PROFILER_AVAILABLE
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#if defined(__GNUC__) || defined(__clang__)
+	#include <cxxabi.h>
+#endif
+
+namespace asmith {
+
+	namespace {
+		enum : uintptr_t {
+			MAX_FRAME_SIZE = 1 << 20	//!< Frame pointer chains that jump further than this are assumed to be corrupt
+		};
+
+		/*!
+			\brief Storage for the samples, allocated by start so that the signal handler never allocates.
+			\detail Sample i occupies frames[i * stride, i * stride + depths[i]), a depth of 0 means that the
+			sample has not been completely written yet.
+		*/
+		struct sample_buffer {
+			std::unique_ptr<uintptr_t[]> frames;
+			std::unique_ptr<std::atomic<uint32_t>[]> depths;
+			uint32_t stride;
+			uint32_t capacity;
+		};
+
+		/*!
+			\brief The address range of a thread's stack.
+		*/
+		struct stack_bounds {
+			uintptr_t low;		//!< The lowest address of the stack
+			uintptr_t high;		//!< One past the highest address of the stack, 0 if the bounds are unknown
+		};
+
+#if defined(__GNUC__) || defined(__clang__)
+		// The initial-exec model makes the variable safe to read from a signal handler, it is never lazily allocated
+		thread_local stack_bounds STACK_BOUNDS __attribute__((tls_model("initial-exec"))) = { 0, 0 };
+#else
+		thread_local stack_bounds STACK_BOUNDS = { 0, 0 };
+#endif
+
+		sample_buffer BUFFER = { nullptr, nullptr, 0, 0 };
+		std::atomic<uint64_t> NEXT_SAMPLE(0);
+		std::atomic<uint64_t> DROPPED(0);
+		std::atomic<bool> RUNNING(false);
+		std::atomic<bool> SAMPLING(false);			//!< Cleared by stop before it waits for handlers to finish
+		std::atomic<uint32_t> ACTIVE_HANDLERS(0);	//!< The number of signal handlers that may be writing to BUFFER
+		struct sigaction PREVIOUS_ACTION;
+
+#if defined(__APPLE__) && (defined(__x86_64__) || defined(__aarch64__))
+	#define ASMITH_SAMPLING_PROFILER_CONTEXT
+#elif defined(__linux__) && (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__))
+	#define ASMITH_SAMPLING_PROFILER_CONTEXT
+#endif
+
+		/*!
+			\brief Read the program counter, stack pointer and frame pointer of an interrupted thread.
+		*/
+		void read_context(const void* const aContext, uintptr_t& aPC, uintptr_t& aSP, uintptr_t& aFP) throw() {
+			const ucontext_t* const context = static_cast<const ucontext_t*>(aContext);
+#if defined(__APPLE__) && defined(__x86_64__)
+			aPC = static_cast<uintptr_t>(context->uc_mcontext->__ss.__rip);
+			aSP = static_cast<uintptr_t>(context->uc_mcontext->__ss.__rsp);
+			aFP = static_cast<uintptr_t>(context->uc_mcontext->__ss.__rbp);
+#elif defined(__APPLE__) && defined(__aarch64__)
+			aPC = static_cast<uintptr_t>(context->uc_mcontext->__ss.__pc);
+			aSP = static_cast<uintptr_t>(context->uc_mcontext->__ss.__sp);
+			aFP = static_cast<uintptr_t>(context->uc_mcontext->__ss.__fp);
+#elif defined(__linux__) && defined(__x86_64__)
+			aPC = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RIP]);
+			aSP = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RSP]);
+			aFP = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RBP]);
+#elif defined(__linux__) && defined(__i386__)
+			aPC = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_EIP]);
+			aSP = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_ESP]);
+			aFP = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_EBP]);
+#elif defined(__linux__) && defined(__aarch64__)
+			aPC = static_cast<uintptr_t>(context->uc_mcontext.pc);
+			aSP = static_cast<uintptr_t>(context->uc_mcontext.sp);
+			aFP = static_cast<uintptr_t>(context->uc_mcontext.regs[29]);
+#else
+			(void) context;
+			aPC = 0;
+			aSP = 0;
+			aFP = 0;
+#endif
+		}
+
+		/*!
+			\brief Check if a frame record (the caller's frame pointer followed by the return address) lies entirely
+			between the stack pointer and the top of the stack.
+		*/
+		inline bool is_valid_frame(const uintptr_t aFP, const uintptr_t aSP, const uintptr_t aHigh) throw() {
+			return aFP >= aSP && aFP % sizeof(uintptr_t) == 0 && aFP < aHigh && aHigh - aFP >= sizeof(uintptr_t) * 2;
+		}
+
+		/*!
+			\brief The SIGPROF handler, must only call async-signal-safe code.
+		*/
+		void handle_signal(int, siginfo_t*, void* aContext) {
+			const int error = errno;
+			// Announce the handler before checking SAMPLING, so stop either sees it or it sees that sampling has stopped
+			ACTIVE_HANDLERS.fetch_add(1, std::memory_order_seq_cst);
+			if(! SAMPLING.load(std::memory_order_seq_cst)) {
+				ACTIVE_HANDLERS.fetch_sub(1, std::memory_order_release);
+				errno = error;
+				return;
+			}
+			uintptr_t pc, sp, fp;
+			read_context(aContext, pc, sp, fp);
+			const uint64_t index = NEXT_SAMPLE.fetch_add(1, std::memory_order_relaxed);
+			if(index >= BUFFER.capacity) {
+				DROPPED.fetch_add(1, std::memory_order_relaxed);
+			}else {
+				uintptr_t* const frames = BUFFER.frames.get() + index * BUFFER.stride;
+				uint32_t depth = 0;
+				frames[depth++] = pc;
+
+				// Each frame starts with the caller's frame pointer followed by the return address. The frame pointer
+				// register may hold unrelated data in code built without frame pointers, so only addresses inside the
+				// thread's stack are read. If the bounds are unknown (or the thread is on an alternate signal stack)
+				// only the program counter is recorded.
+				const stack_bounds bounds = STACK_BOUNDS;
+				if(bounds.high != 0 && sp >= bounds.low && sp < bounds.high) {
+					while(depth < BUFFER.stride && is_valid_frame(fp, sp, bounds.high)) {
+						const uintptr_t* const frame = reinterpret_cast<const uintptr_t*>(fp);
+						const uintptr_t next = frame[0];
+						const uintptr_t return_address = frame[1];
+						if(return_address == 0) break;
+						frames[depth++] = return_address;
+						if(next <= fp || next - fp > MAX_FRAME_SIZE) break;
+						fp = next;
+					}
+				}
+
+				BUFFER.depths[index].store(depth, std::memory_order_release);
+			}
+			ACTIVE_HANDLERS.fetch_sub(1, std::memory_order_release);
+			errno = error;
+		}
+
+		/*!
+			\brief Convert an address into a function name.
+			\param aAddress The address.
+			\param aReturnAddress True if the address is a return address, it is moved back into the call instruction.
+		*/
+		std::string symbolise(const uintptr_t aAddress, const bool aReturnAddress) {
+			const uintptr_t address = aReturnAddress ? aAddress - 1 : aAddress;
+			Dl_info info;
+			char buffer[64];
+			if(dladdr(reinterpret_cast<void*>(address), &info) == 0) {
+				std::snprintf(buffer, sizeof(buffer), "0x%llx", static_cast<unsigned long long>(address));
+				return buffer;
+			}
+
+			if(info.dli_sname != nullptr) {
+#if defined(__GNUC__) || defined(__clang__)
+				int status = 0;
+				char* const demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+				if(demangled != nullptr) {
+					std::string tmp = demangled;
+					std::free(demangled);
+					return tmp;
+				}
+#endif
+				return info.dli_sname;
+			}
+
+			// Group unnamed functions by module so that they do not split the stacks of their callers
+			const char* module = info.dli_fname == nullptr ? "?" : info.dli_fname;
+			const char* const slash = std::strrchr(module, '/');
+			if(slash != nullptr) module = slash + 1;
+			return '[' + std::string(module) + ']';
+		}
+	}
+
+	// sampling_profiler
+
+	bool sampling_profiler::register_thread() {
+		stack_bounds bounds = { 0, 0 };
+#if defined(__APPLE__)
+		pthread_t thread = pthread_self();
+		bounds.high = reinterpret_cast<uintptr_t>(pthread_get_stackaddr_np(thread));
+		bounds.low = bounds.high - static_cast<uintptr_t>(pthread_get_stacksize_np(thread));
+#elif defined(__linux__)
+		pthread_attr_t attributes;
+		if(pthread_getattr_np(pthread_self(), &attributes) != 0) return false;
+		void* address = nullptr;
+		size_t size = 0;
+		const int error = pthread_attr_getstack(&attributes, &address, &size);
+		pthread_attr_destroy(&attributes);
+		if(error != 0) return false;
+		bounds.low = reinterpret_cast<uintptr_t>(address);
+		bounds.high = bounds.low + static_cast<uintptr_t>(size);
+#else
+		return false;
+#endif
+		STACK_BOUNDS = bounds;
+		return true;
+	}
+
+	bool sampling_profiler::start(const sampling_profiler_options& aOptions) {
+#ifndef ASMITH_SAMPLING_PROFILER_CONTEXT
+		return false;
+#endif
+		if(aOptions.frequency == 0 || aOptions.capacity == 0) return false;
+		register_thread();
+
+		bool expected = false;
+		if(! RUNNING.compare_exchange_strong(expected, true)) return false;
+
+		BUFFER.stride = aOptions.max_depth == 0 ? 1 : aOptions.max_depth;
+		BUFFER.capacity = aOptions.capacity;
+		BUFFER.frames.reset(new uintptr_t[static_cast<size_t>(BUFFER.stride) * BUFFER.capacity]);
+		BUFFER.depths.reset(new std::atomic<uint32_t>[BUFFER.capacity]);
+		for(uint32_t i = 0; i < BUFFER.capacity; ++i) BUFFER.depths[i].store(0, std::memory_order_relaxed);
+		NEXT_SAMPLE.store(0, std::memory_order_relaxed);
+		DROPPED.store(0, std::memory_order_release);
+		SAMPLING.store(true, std::memory_order_seq_cst);
+
+		struct sigaction action;
+		std::memset(&action, 0, sizeof(action));
+		action.sa_sigaction = handle_signal;
+		action.sa_flags = SA_SIGINFO | SA_RESTART;
+		sigemptyset(&action.sa_mask);
+		if(sigaction(SIGPROF, &action, &PREVIOUS_ACTION) != 0) {
+			SAMPLING.store(false);
+			RUNNING.store(false);
+			return false;
+		}
+
+		const long interval = aOptions.frequency >= 1000000 ? 1 : static_cast<long>(1000000 / aOptions.frequency);
+		itimerval timer;
+		timer.it_interval.tv_sec = interval / 1000000;
+		timer.it_interval.tv_usec = interval % 1000000;
+		timer.it_value = timer.it_interval;
+		if(setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+			sigaction(SIGPROF, &PREVIOUS_ACTION, nullptr);
+			SAMPLING.store(false);
+			RUNNING.store(false);
+			return false;
+		}
+		return true;
+	}
+
+	void sampling_profiler::stop() {
+		if(! RUNNING.load()) return;
+		itimerval timer;
+		std::memset(&timer, 0, sizeof(timer));
+		setitimer(ITIMER_PROF, &timer, nullptr);
+
+		// Ignore signals that are already pending rather than restoring a handler that may terminate the process
+		struct sigaction action;
+		std::memset(&action, 0, sizeof(action));
+		action.sa_handler = SIG_IGN;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGPROF, &action, nullptr);
+		sigaction(SIGPROF, &PREVIOUS_ACTION, nullptr);
+
+		// Handlers already running on other threads may still be writing to the buffer, which start and clear modify
+		SAMPLING.store(false, std::memory_order_seq_cst);
+		while(ACTIVE_HANDLERS.load(std::memory_order_seq_cst) != 0) std::this_thread::yield();
+		RUNNING.store(false);
+	}
+
+	bool sampling_profiler::is_running() {
+		return RUNNING.load();
+	}
+
+	void sampling_profiler::clear() {
+		if(RUNNING.load()) return;
+		for(uint32_t i = 0; i < BUFFER.capacity; ++i) BUFFER.depths[i].store(0, std::memory_order_relaxed);
+		NEXT_SAMPLE.store(0, std::memory_order_relaxed);
+		DROPPED.store(0, std::memory_order_relaxed);
+	}
+
+	uint64_t sampling_profiler::get_sample_count() {
+		const uint64_t count = NEXT_SAMPLE.load(std::memory_order_relaxed);
+		return count < BUFFER.capacity ? count : BUFFER.capacity;
+	}
+
+	uint64_t sampling_profiler::get_dropped() {
+		return DROPPED.load(std::memory_order_relaxed);
+	}
+
+	void sampling_profiler::write_folded(std::ostream& aStream) {
+		if(RUNNING.load()) return;
+		const uint64_t count = get_sample_count();
+
+		std::map<uintptr_t, std::string> symbols[2];
+		std::map<std::string, uint64_t> stacks;
+		std::string stack;
+		for(uint64_t i = 0; i < count; ++i) {
+			const uint32_t depth = BUFFER.depths[i].load(std::memory_order_acquire);
+			if(depth == 0) continue;
+			const uintptr_t* const frames = BUFFER.frames.get() + i * BUFFER.stride;
+
+			stack.clear();
+			for(uint32_t j = depth; j > 0; --j) {
+				// The first frame is the program counter, the others are return addresses
+				const bool return_address = j != 1;
+				std::map<uintptr_t, std::string>& cache = symbols[return_address ? 1 : 0];
+				std::map<uintptr_t, std::string>::iterator k = cache.find(frames[j - 1]);
+				if(k == cache.end()) {
+					std::string name = symbolise(frames[j - 1], return_address);
+					// ';' separates frames and whitespace separates the count
+					for(char& c : name) if(c == ';' || c == ' ' || c == '\n') c = '_';
+					k = cache.emplace(frames[j - 1], std::move(name)).first;
+				}
+				if(! stack.empty()) stack += ';';
+				stack += k->second;
+			}
+			++stacks[stack];
+		}
+
+		for(const std::pair<const std::string, uint64_t>& i : stacks) aStream << i.first << ' ' << i.second << '\n';
+	}
+}
+
+#else
+
+namespace asmith {
+
+	bool sampling_profiler::start(const sampling_profiler_options&) {
+		return false;
+	}
+
+	void sampling_profiler::stop() {
+
+	}
+
+	bool sampling_profiler::is_running() {
+		return false;
+	}
+
+	bool sampling_profiler::register_thread() {
+		return false;
+	}
+
+	void sampling_profiler::clear() {
+
+	}
+
+	uint64_t sampling_profiler::get_sample_count() {
+		return 0;
+	}
+
+	uint64_t sampling_profiler::get_dropped() {
+		return 0;
+	}
+
+	void sampling_profiler::write_folded(std::ostream&) {
+
+	}
+}
+
+#endif
\ No newline at end of file
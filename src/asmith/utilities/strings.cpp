@@ -27,7 +27,7 @@ namespace asmith { namespace strings {
 		\return The converted character, or aChar if it is not a lower case letter.
 	*/
 	char to_upper_case(char aChar) throw() {
-		return is_upper_case(aChar) ? aChar + CASE_DIFFERENCE : aChar;
+		return is_lower_case(aChar) ? aChar + CASE_DIFFERENCE : aChar;
 	}
 
 	/*!
@@ -56,7 +56,7 @@ namespace asmith { namespace strings {
 		\return The converted character, or aChar if it is not an upper case letter.
 	*/
 	char to_lower_case(char aChar) throw() {
-		return is_lower_case(aChar) ? aChar - CASE_DIFFERENCE : aChar;
+		return is_upper_case(aChar) ? aChar - CASE_DIFFERENCE : aChar;
 	}
 	
 	/*!
@@ -346,7 +346,7 @@ namespace asmith { namespace strings {
 	*/
 	int strcmp_ignore_case(const char* aStr1, const char* aStr2, size_t aSize) throw() {
 		for(size_t i = 0; i < aSize; ++i){
-			if(aStr1[i] == '\0') aStr2[i] == '\0' ? 0 : 1;;
+			if(aStr1[i] == '\0') return aStr2[i] == '\0' ? 0 : 1;
 			const char a = to_lower_case(aStr1[i]);
 			const char b = to_lower_case(aStr2[i]);
 			if(a < b) return -1;
@@ -467,7 +467,7 @@ namespace asmith { namespace strings {
 	*/
 	const char* find_any(const char* aStr, size_t aStrSize, const char* aTargets, size_t aTargetsSize) throw() {
 		for(size_t i = 0; i < aStrSize; ++i) {
-			for(size_t j = 0; j < aTargetsSize; ++i) if(aStr[i] == aTargets[j]) return aStr + i;
+			for(size_t j = 0; j < aTargetsSize; ++j) if(aStr[i] == aTargets[j]) return aStr + i;
 		}
 		return nullptr;
 	}
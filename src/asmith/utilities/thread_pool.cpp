@@ -0,0 +1,271 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#include "asmith/utilities/thread_pool.hpp"
+
+#if defined(_WIN32)
+	#include <windows.h>
+#elif defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+namespace asmith {
+
+	namespace {
+		enum : size_t {
+			SPIN_ROUNDS = 64	//!< Number of times an idle worker looks for work before sleeping
+		};
+
+		/*!
+			\brief Bind the calling thread to a single CPU.
+		*/
+		void pin_thread(const size_t aCPU) throw() {
+#if defined(_WIN32)
+			SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << (aCPU % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(aCPU % CPU_SETSIZE, &set);
+			pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+			// Affinity is not supported on this platform
+			static_cast<void>(aCPU);
+#endif
+		}
+
+		/*!
+			\brief Get a pseudo-random number for picking steal victims.
+		*/
+		uint32_t next_random() throw() {
+			static thread_local uint32_t STATE = 0;
+			if(STATE == 0) STATE = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+			STATE ^= STATE << 13;
+			STATE ^= STATE >> 17;
+			STATE ^= STATE << 5;
+			return STATE;
+		}
+
+		size_t hardware_threads() throw() {
+			const size_t threads = std::thread::hardware_concurrency();
+			return threads == 0 ? 1 : threads;
+		}
+	}
+
+	// thread_pool::worker
+
+	struct thread_pool::worker {
+		thread_pool* pool;							//!< The pool that owns the worker
+		size_t index;								//!< The position of the worker in the pool
+		implementation::work_stealing_deque deque;	//!< Tasks spawned by the worker
+		std::thread thread;
+	};
+
+	// thread_pool
+
+	thread_pool::thread_pool(const thread_pool_options& aOptions) :
+		mWorkerCount(0),
+		mQueueSize(0),
+		mSleeping(0),
+		mGeneration(0),
+		mStopping(false)
+	{
+		const size_t threads = aOptions.threads == 0 ? hardware_threads() - 1 : aOptions.threads;
+
+		// Create every worker before starting any threads, so that thieves never see the vector change
+		mWorkers.reserve(threads);
+		for(size_t i = 0; i < threads; ++i) {
+			mWorkers.push_back(std::unique_ptr<worker>(new worker()));
+			mWorkers.back()->pool = this;
+			mWorkers.back()->index = i;
+		}
+
+		const bool pin = aOptions.pin_threads;
+		try {
+			for(const std::unique_ptr<worker>& i : mWorkers) {
+				worker* const w = i.get();
+				w->thread = std::thread([this, w, pin]() {
+					worker_main(w, pin);
+				});
+				++mWorkerCount;
+			}
+		}catch(std::exception&) {
+			// Not enough threads could be created, threads that wait on a task_group run the remaining work
+		}
+	}
+
+	thread_pool::~thread_pool() {
+		{
+			std::lock_guard<std::mutex> lock(mSleepLock);
+			mStopping = true;
+			++mGeneration;
+		}
+		mSleepCondition.notify_all();
+		for(const std::unique_ptr<worker>& i : mWorkers) if(i->thread.joinable()) i->thread.join();
+
+		// Run anything that was submitted without being waited on
+		while(run_one());
+	}
+
+	thread_pool& thread_pool::get_default() {
+		static thread_pool POOL;
+		return POOL;
+	}
+
+	thread_pool::worker*& thread_pool::current_worker() throw() {
+		static thread_local worker* WORKER = nullptr;
+		return WORKER;
+	}
+
+	size_t thread_pool::get_worker_count() const throw() {
+		return mWorkerCount;
+	}
+
+	size_t thread_pool::get_concurrency() const throw() {
+		return mWorkerCount + 1;
+	}
+
+	bool thread_pool::is_worker() const throw() {
+		const worker* const w = current_worker();
+		return w != nullptr && w->pool == this;
+	}
+
+	void thread_pool::worker_main(worker* const aWorker, const bool aPin) {
+		current_worker() = aWorker;
+		if(aPin) pin_thread(aWorker->index);
+
+		while(true) {
+			implementation::pool_task* task = find_task(aWorker);
+			for(size_t i = 0; task == nullptr && i < SPIN_ROUNDS; ++i) {
+				std::this_thread::yield();
+				task = find_task(aWorker);
+			}
+			if(task != nullptr) {
+				execute(task);
+				continue;
+			}
+
+			// Announce that the worker is going to sleep and then check again, so that a submit either sees the
+			// announcement and wakes the worker or the worker sees the new task
+			std::unique_lock<std::mutex> lock(mSleepLock);
+			if(mStopping) {
+				if(has_work()) continue;
+				break;
+			}
+			const uint64_t generation = mGeneration;
+			mSleeping.fetch_add(1, std::memory_order_seq_cst);
+			if(! has_work()) {
+				mSleepCondition.wait(lock, [this, generation]()->bool {
+					return mGeneration != generation || mStopping;
+				});
+			}
+			mSleeping.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		current_worker() = nullptr;
+	}
+
+	implementation::pool_task* thread_pool::find_task(worker* const aWorker) throw() {
+		implementation::pool_task* task = nullptr;
+
+		// Newest task of the calling worker
+		if(aWorker != nullptr) {
+			task = aWorker->deque.pop();
+			if(task != nullptr) return task;
+		}
+
+		// Tasks submitted from outside of the pool
+		if(mQueueSize.load(std::memory_order_acquire) != 0) {
+			std::lock_guard<std::mutex> lock(mQueueLock);
+			if(! mQueue.empty()) {
+				task = mQueue.front();
+				mQueue.pop_front();
+				mQueueSize.fetch_sub(1, std::memory_order_relaxed);
+				return task;
+			}
+		}
+
+		// Oldest task of another worker, starting at a random victim so that thieves spread out
+		const size_t count = mWorkers.size();
+		if(count == 0) return nullptr;
+		const size_t first = next_random() % count;
+		for(size_t i = 0; i < count; ++i) {
+			worker& victim = *mWorkers[(first + i) % count];
+			if(&victim == aWorker) continue;
+			task = victim.deque.steal();
+			if(task != nullptr) return task;
+		}
+		return nullptr;
+	}
+
+	bool thread_pool::has_work() throw() {
+		if(mQueueSize.load(std::memory_order_seq_cst) != 0) return true;
+		for(const std::unique_ptr<worker>& i : mWorkers) if(! i->deque.empty()) return true;
+		return false;
+	}
+
+	void thread_pool::wake() throw() {
+		// A read-modify-write orders the load after the task was published, pairing with the increment in worker_main
+		if(mSleeping.fetch_add(0, std::memory_order_seq_cst) == 0) return;
+		{
+			std::lock_guard<std::mutex> lock(mSleepLock);
+			++mGeneration;
+		}
+		mSleepCondition.notify_one();
+	}
+
+	void thread_pool::execute(implementation::pool_task* const aTask) throw() {
+		task_group* const group = aTask->group;
+		if(! group->is_cancelled()) {
+			try {
+				aTask->function();
+			}catch(...) {
+				group->set_exception(std::current_exception());
+			}
+		}
+		delete aTask;
+
+		// This must be the last access to the group, a waiting thread may destroy it as soon as the count reaches 0
+		group->mPending.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	void thread_pool::submit(implementation::pool_task* const aTask) {
+		worker* const w = current_worker();
+		if(w != nullptr && w->pool == this) {
+			if(! w->deque.push(aTask)) {
+				execute(aTask);
+				return;
+			}
+		}else {
+			try {
+				std::lock_guard<std::mutex> lock(mQueueLock);
+				mQueue.push_back(aTask);
+				mQueueSize.fetch_add(1, std::memory_order_release);
+			}catch(std::exception&) {
+				// The queue could not grow, run the task on the calling thread instead
+				execute(aTask);
+				return;
+			}
+		}
+		wake();
+	}
+
+	bool thread_pool::run_one() throw() {
+		worker* w = current_worker();
+		if(w != nullptr && w->pool != this) w = nullptr;
+		implementation::pool_task* const task = find_task(w);
+		if(task == nullptr) return false;
+		execute(task);
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+//	Copyright 2017 Adam Smith
+//	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+// 
+//	http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+
+#include "asmith/utilities/tsc_timer.hpp"
+#include <thread>
+
+#if defined(ASMITH_TSC_AVAILABLE) && ! defined(_MSC_VER)
+	#include <cpuid.h>
+#endif
+
+namespace asmith { namespace implementation {
+
+	enum {
+		CALIBRATION_MILLISECONDS = 20
+	};
+
+	/*!
+		\brief Check if the CPU reports an invariant TSC (CPUID.80000007H:EDX[8]).
+	*/
+	static bool detect_invariant_tsc() throw() {
+#if defined(ASMITH_TSC_AVAILABLE)
+	#if defined(_MSC_VER)
+		int regs[4];
+		__cpuid(regs, 0x80000000);
+		if(static_cast<unsigned int>(regs[0]) < 0x80000007) return false;
+		__cpuid(regs, 0x80000007);
+		return (regs[3] & (1 << 8)) != 0;
+	#else
+		unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+		if(__get_cpuid_max(0x80000000, nullptr) < 0x80000007) return false;
+		if(! __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+		return (edx & (1 << 8)) != 0;
+	#endif
+#else
+		return false;
+#endif
+	}
+
+	/*!
+		\brief Measure the TSC frequency against std::chrono::steady_clock.
+	*/
+	static tsc_calibration calibrate() throw() {
+		tsc_calibration tmp;
+		tmp.invariant = detect_invariant_tsc();
+		tmp.use_tsc = false;
+		tmp.nanoseconds_per_tick = 1.0;
+
+#if defined(ASMITH_TSC_AVAILABLE)
+		if(! tmp.invariant) return tmp;
+
+		const uint64_t clock_begin = steady_clock_ticks();
+		const uint64_t tsc_begin = __rdtsc();
+		uint64_t clock_end = clock_begin;
+		while(clock_end - clock_begin < CALIBRATION_MILLISECONDS * 1000000ULL) {
+			std::this_thread::yield();
+			clock_end = steady_clock_ticks();
+		}
+		const uint64_t tsc_end = __rdtsc();
+
+		if(tsc_end > tsc_begin) {
+			tmp.nanoseconds_per_tick = static_cast<double>(clock_end - clock_begin) / static_cast<double>(tsc_end - tsc_begin);
+			tmp.use_tsc = true;
+		}
+#endif
+		return tmp;
+	}
+
+	const tsc_calibration& get_tsc_calibration() throw() {
+		static const tsc_calibration CALIBRATION = calibrate();
+		return CALIBRATION;
+	}
+}}
\ No newline at end of file